@@ -0,0 +1,104 @@
+#ifndef GRAYSET_ARENA_H
+#define GRAYSET_ARENA_H
+
+#include "header.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Bump allocator over large blocks, memory is only given back all at once
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+
+    Block* _head;
+    size_t _block;
+    size_t _bytes;
+    size_t _reserved;
+    size_t _blocks;
+
+    static unsigned char* _base(Block* block) {
+        return reinterpret_cast<unsigned char*>(block) + sizeof(Block);
+    }
+
+    // Offset in block where allocation with given alignment would start
+    static size_t _offset(Block* block, size_t align) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(_base(block) + block->used);
+        return block->used + ((align - address % align) % align);
+    }
+
+    void _grow(size_t size) {
+        size_t capacity = std::max(this->_block, size);
+        auto block = static_cast<Block*>(::operator new(sizeof(Block) + capacity));
+        block->next = this->_head;
+        block->size = capacity;
+        block->used = 0;
+        this->_head = block;
+        this->_reserved += capacity;
+        this->_blocks++;
+    }
+
+public:
+    explicit Arena(size_t block = 1u << 20):
+    _head(nullptr), _block(block), _bytes(0), _reserved(0), _blocks(0) {
+        if (block == 0)
+            throw std::range_error("Arena block size must greater than 0.");
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (this->_head == nullptr || _offset(this->_head, align) + size > this->_head->size)
+            this->_grow(size + align);
+
+        size_t offset = _offset(this->_head, align);
+        this->_head->used = offset + size;
+        this->_bytes += size;
+        return _base(this->_head) + offset;
+    }
+
+    // Grow most recent allocation in place when it is at the top of current block
+    bool extend(void* pointer, size_t size, size_t target) {
+        if (this->_head == nullptr || target < size)
+            return false;
+        unsigned char* top = _base(this->_head) + this->_head->used;
+        if (static_cast<unsigned char*>(pointer) + size != top)
+            return false;
+        if (this->_head->used - size + target > this->_head->size)
+            return false;
+
+        this->_head->used += target - size;
+        this->_bytes += target - size;
+        return true;
+    }
+
+    // Free all blocks, every pointer handed out before becomes invalid
+    void release() {
+        while (this->_head != nullptr) {
+            Block* next = this->_head->next;
+            ::operator delete(this->_head);
+            this->_head = next;
+        }
+        this->_bytes = 0;
+        this->_reserved = 0;
+        this->_blocks = 0;
+    }
+
+    size_t bytes() const { return this->_bytes; }
+    size_t reserved() const { return this->_reserved; }
+    size_t blocks() const { return this->_blocks; }
+
+    ~Arena() { this->release(); }
+};
+
+// Types whose copy can take its own storage from an arena through a (const T&, Arena*) constructor
+template <typename T, typename = void>
+struct ArenaCopy: std::false_type {};
+
+#endif //GRAYSET_ARENA_H
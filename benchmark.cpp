@@ -0,0 +1,349 @@
+#include "functions.h"
+#include "executor.h"
+#include "format.h"
+#include "sampler.h"
+
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <new>
+
+// Every allocation of the process is counted, so cases report what they allocate
+static std::atomic<size_t> allocations(0);
+static std::atomic<size_t> allocated(0);
+
+static void* counted(size_t size, size_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated.fetch_add(size, std::memory_order_relaxed);
+    void* pointer = nullptr;
+    if (align <= alignof(std::max_align_t))
+        pointer = malloc(size == 0 ? 1 : size);
+    else if (posix_memalign(&pointer, align, size == 0 ? align : size) != 0)
+        pointer = nullptr;
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size) { return counted(size, 0); }
+void* operator new[](size_t size) { return counted(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return counted(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted(size, static_cast<size_t>(align)); }
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { free(pointer); }
+
+typedef std::chrono::steady_clock Clock;
+
+// Options of one run, every case uses same data for same seed
+struct Options {
+    Vector<unsigned int> powers;
+    size_t cardinality = 0;
+    unsigned int repetitions = 10;
+    unsigned int warmup = 2;
+    unsigned int universe = 22;
+    uint64_t seed = 1;
+    std::string format = "text";
+    std::string output;
+    std::string filter;
+};
+
+struct Result {
+    std::string name;
+    unsigned int power;
+    size_t cardinality;
+    size_t operations;
+    unsigned int repetitions;
+    double median;
+    double p99;
+    double minimum;
+    double mean;
+    size_t allocations;
+    size_t bytes;
+};
+
+// Case prepares its data once, then body is timed for every repetition and returns operation count
+struct Case {
+    std::string name;
+    std::function<size_t()> body;
+};
+
+// Sink keeps results alive so optimizer can not drop the work
+static volatile size_t sink = 0;
+
+static size_t keep(size_t value, size_t operations) {
+    sink = sink + value;
+    return operations;
+}
+
+static Result measure(const Options& options, const Case& test, unsigned int power, size_t cardinality) {
+    for (unsigned int _ = 0; _ < options.warmup; _++)
+        sink = sink + test.body();
+
+    Vector<double> times;
+    size_t operations = 0;
+    size_t count = 0;
+    size_t bytes = 0;
+    for (unsigned int _ = 0; _ < options.repetitions; _++) {
+        const size_t before = allocations.load();
+        const size_t size = allocated.load();
+        auto begin = Clock::now();
+        operations = test.body();
+        times.append(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+        count = allocations.load() - before;
+        bytes = allocated.load() - size;
+        sink = sink + operations;
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (const auto time: times)
+        total += time;
+
+    // Nearest rank percentiles over sorted repetitions
+    const size_t last = times.count() - 1;
+    Result result;
+    result.name = test.name;
+    result.power = power;
+    result.cardinality = cardinality;
+    result.operations = operations;
+    result.repetitions = options.repetitions;
+    result.median = times[last / 2];
+    result.p99 = times[std::min(last, static_cast<size_t>(times.count() * 0.99))];
+    result.minimum = times[0];
+    result.mean = total / times.count();
+    result.allocations = count;
+    result.bytes = bytes;
+    return result;
+}
+
+static Vector<Gray> codes(std::mt19937_64& engine, unsigned int power, size_t count) {
+    const uint64_t mask = power >= 64 ? ~0ull : (1ull << power) - 1;
+    Vector<Gray> result;
+    result.reserve(count);
+    for (size_t _ = 0; _ < count; _++) {
+        Gray gray(power);
+        gray.import(engine() & mask);
+        result.append(std::move(gray));
+    }
+    return result;
+}
+
+// All cases for one power, cases over whole universe only run up to universe limit
+static void cases(const Options& options, unsigned int power, size_t cardinality, Vector<Result>& results) {
+    std::mt19937_64 engine(options.seed ^ power);
+    // Generator behind random sets is global, restart it so random case repeats under same seed
+    seed(options.seed ^ power);
+    const Vector<Gray> values = codes(engine, power, cardinality);
+    const Vector<Gray> probes = codes(engine, power, cardinality);
+    const Set<Gray> seta = Set<Gray>::from_range(values.begin(), values.end());
+    const Set<Gray> setb = Set<Gray>::from_range(probes.begin(), probes.end());
+    const Set<Gray> multiset = Set<Gray>::from_range(values.begin(), values.end(), false);
+    const bool whole = power <= options.universe;
+    const Set<Gray> all = whole ? universal(power) : Set<Gray>(1);
+
+    // Product grows with square of cardinality, so operands are cut to keep it bounded
+    const size_t side = std::min<size_t>(cardinality, 256);
+    const Set<Gray> rows = Set<Gray>::from_range(values.begin(), values.begin() + side);
+    const Set<Gray> columns = Set<Gray>::from_range(probes.begin(), probes.begin() + side);
+    const Executor executor;
+
+    Vector<Case> list;
+    list.append(Case{"gray_import", [&]() {
+        size_t total = 0;
+        Gray gray(power);
+        for (size_t _ = 0; _ < cardinality; _++) {
+            gray.import(_);
+            total += gray.decimal() & 1u;
+        }
+        sink = sink + total;
+        return cardinality;
+    }});
+    if (whole)
+        list.append(Case{"universal", [&]() { return universal(power).count(); }});
+    list.append(Case{"random", [&]() { return random(power, cardinality, true).count(); }});
+    list.append(Case{"sampler", [&]() {
+        uint64_t total = 0;
+        for (const auto code: Sampler(power, std::min<uint64_t>(cardinality, 1ull << power), options.seed))
+            total += code & 1u;
+        sink = sink + total;
+        return cardinality;
+    }});
+    list.append(Case{"set_add", [&]() {
+        Set<Gray> set(16);
+        for (const auto& value: values)
+            set.add(value);
+        return values.count();
+    }});
+    list.append(Case{"set_add_range", [&]() {
+        return keep(Set<Gray>::from_range(values.begin(), values.end()).count(), values.count());
+    }});
+    list.append(Case{"set_in", [&]() {
+        size_t found = 0;
+        for (const auto& value: probes)
+            found += seta.in(value);
+        sink = sink + found;
+        return probes.count();
+    }});
+    list.append(Case{"intersection", [&]() { return keep(seta.intersection(setb).count(), cardinality); }});
+    list.append(Case{"union", [&]() { return keep(seta.union_(setb).count(), cardinality); }});
+    list.append(Case{"difference", [&]() { return keep(seta.difference(setb).count(), cardinality); }});
+    list.append(Case{"symdiff", [&]() { return keep(seta.symdiff(setb).count(), cardinality); }});
+    if (whole)
+        list.append(Case{"complement", [&]() { return keep(seta.complement(all).count(), all.count()); }});
+    // Same results built in an arena, storage is taken in large blocks and freed at once
+    list.append(Case{"symdiff_arena", [&]() {
+        Arena arena;
+        Set<Gray> set(1, true, 0.875f, &arena);
+        set |= seta;
+        set ^= setb;
+        return keep(set.count(), cardinality);
+    }});
+    if (whole)
+        list.append(Case{"complement_arena", [&]() {
+            Arena arena;
+            Set<Gray> set(1, true, 0.875f, &arena);
+            set |= all;
+            set -= seta;
+            return keep(set.count(), all.count());
+        }});
+    list.append(Case{"intersect_with", [&]() {
+        Set<Gray> set(seta);
+        set &= setb;
+        return cardinality;
+    }});
+    list.append(Case{"intersection_parallel", [&]() {
+        return keep(seta.intersection(setb, executor).count(), cardinality);
+    }});
+    list.append(Case{"union_parallel", [&]() {
+        return keep(seta.union_(setb, executor).count(), cardinality);
+    }});
+    list.append(Case{"product", [&]() { return rows.product(columns).count(); }});
+    list.append(Case{"product_parallel", [&]() { return rows.product(columns, executor).count(); }});
+    list.append(Case{"analysis", [&]() { return multiset.analysis().count(); }});
+
+    for (const auto& test: list) {
+        if (!options.filter.empty() && test.name.find(options.filter) == std::string::npos)
+            continue;
+        results.append(measure(options, test, power, cardinality));
+    }
+}
+
+// Machine readable output keeps whole nanoseconds
+static uint64_t rounded(double nanoseconds) {
+    return static_cast<uint64_t>(nanoseconds + 0.5);
+}
+
+static void report(Writer& out, const Options& options, const Vector<Result>& results) {
+    if (options.format == "json") {
+        out << "[\n";
+        for (size_t _ = 0; _ < results.count(); _++) {
+            const Result& result = results[_];
+            out << "  {\"name\": \"" << result.name << "\", \"power\": " << result.power
+                << ", \"cardinality\": " << result.cardinality << ", \"operations\": " << result.operations
+                << ", \"repetitions\": " << result.repetitions
+                << ", \"median_ns\": " << rounded(result.median) << ", \"p99_ns\": " << rounded(result.p99)
+                << ", \"min_ns\": " << rounded(result.minimum) << ", \"mean_ns\": " << rounded(result.mean)
+                << ", \"allocations\": " << result.allocations << ", \"bytes\": " << result.bytes << '}'
+                << (_ + 1 < results.count() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        return;
+    }
+
+    if (options.format == "csv") {
+        out << "name,power,cardinality,operations,repetitions,median_ns,p99_ns,min_ns,mean_ns,allocations,bytes\n";
+        for (const auto& result: results)
+            out << result.name << ',' << result.power << ',' << result.cardinality << ',' << result.operations << ','
+                << result.repetitions << ',' << rounded(result.median) << ',' << rounded(result.p99) << ',' << rounded(result.minimum) << ','
+                << rounded(result.mean) << ',' << result.allocations << ',' << result.bytes << '\n';
+        return;
+    }
+
+    out << "Case\tPower\tCard\tMedian(us)\tP99(us)\tns/op\tAllocs\tBytes\n";
+    for (const auto& result: results)
+        out << result.name << '\t' << result.power << '\t' << result.cardinality << '\t'
+            << result.median / 1e3 << '\t' << result.p99 / 1e3 << '\t'
+            << (result.operations ? result.median / result.operations : 0) << '\t'
+            << result.allocations << '\t' << result.bytes << '\n';
+}
+
+static void usage() {
+    std::cout << "Usage: GraySetBench [--powers 4,8,16,20] [--cardinality N] [--repetitions N] [--warmup N]"
+              << " [--universe POWER] [--seed N] [--filter NAME] [--format text|json|csv] [--output PATH]"
+              << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+    Options options;
+    for (int index = 1; index < argc; index++) {
+        std::string flag = argv[index];
+        if (flag == "--help") {
+            usage();
+            return 0;
+        }
+        if (index + 1 >= argc) {
+            usage();
+            return 2;
+        }
+
+        const char* value = argv[++index];
+        if (flag == "--powers") {
+            char* cursor = const_cast<char*>(value);
+            do {
+                options.powers.append(strtoul(cursor, &cursor, 10));
+            } while (*cursor++ == ',');
+        } else if (flag == "--cardinality") {
+            options.cardinality = strtoull(value, nullptr, 10);
+        } else if (flag == "--repetitions") {
+            options.repetitions = std::max(1ul, strtoul(value, nullptr, 10));
+        } else if (flag == "--warmup") {
+            options.warmup = strtoul(value, nullptr, 10);
+        } else if (flag == "--universe") {
+            options.universe = strtoul(value, nullptr, 10);
+        } else if (flag == "--seed") {
+            options.seed = strtoull(value, nullptr, 10);
+        } else if (flag == "--filter") {
+            options.filter = value;
+        } else if (flag == "--format") {
+            options.format = value;
+        } else if (flag == "--output") {
+            options.output = value;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (options.powers.empty())
+        for (unsigned int power: {4u, 8u, 12u, 16u, 20u})
+            options.powers.append(power);
+
+    Vector<Result> results;
+    for (const auto power: options.powers) {
+        if (power < 4 || power > 30) {
+            std::cout << "Invalid power range." << std::endl;
+            return 2;
+        }
+
+        // Default cardinality is half of universe, bounded so large powers stay practical
+        size_t cardinality = options.cardinality;
+        if (cardinality == 0)
+            cardinality = std::min<size_t>(1ull << (power - 1), 1u << 18);
+        cases(options, power, cardinality, results);
+    }
+
+    if (options.output.empty()) {
+        report(console(), options, results);
+        console().flush();
+    } else {
+        Writer out(options.output.c_str());
+        report(out, options, results);
+        out.flush();
+    }
+    return 0;
+}
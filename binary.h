@@ -2,80 +2,349 @@
 #define GRAYSET_BINARY_H
 
 #include "header.h"
+#include "bits.h"
+#include "arena.h"
+
+#include <atomic>
 
 class Binary {
 
+public:
+    // Widths up to this many bits are stored inline without heap allocation
+    static const size_t INLINE_BITS = 128;
+
 private:
+    static const size_t WORD_BITS = 64;
+    static const size_t INLINE_WORDS = INLINE_BITS / WORD_BITS;
+
     size_t _size;
-    unsigned char* _pool;
+    union {
+        uint64_t _inline[INLINE_WORDS];
+        uint64_t* _heap;
+    };
+#ifdef CACHE_HASH
+    // Relaxed atomic, as const readers on several threads may fill it at once with the same value
+    mutable std::atomic<uint64_t> _hash{0};
+#endif
+
+    bool _local() const { return this->_size <= INLINE_BITS; }
+
+    // Any mutable access may change bits, so cached hash is dropped here
+    uint64_t* _data() {
+#ifdef CACHE_HASH
+        this->_hash.store(0, std::memory_order_relaxed);
+#endif
+        return this->_local() ? this->_inline : this->_heap + 1;
+    }
+    const uint64_t* _data() const { return this->_local() ? this->_inline : this->_heap + 1; }
+
+    // Mask of valid bits in last word, bits above size are always kept zero
+    uint64_t _mask() const {
+        size_t rest = this->_size % WORD_BITS;
+        return rest == 0 ? ~0ull : (1ull << rest) - 1;
+    }
+
+    // Heap block starts with one word holding its arena, null when from operator new
+    void _allocate(Arena* arena = nullptr) {
+        if (this->_local()) {
+            memset(this->_inline, 0, sizeof(this->_inline));
+            return;
+        }
+
+        size_t count = this->words() + 1;
+        if (arena != nullptr)
+            this->_heap = static_cast<uint64_t*>(arena->allocate(count * sizeof(uint64_t), alignof(uint64_t)));
+        else
+            this->_heap = new uint64_t[count];
+        memset(this->_heap, 0, count * sizeof(uint64_t));
+        this->_heap[0] = reinterpret_cast<uintptr_t>(arena);
+    }
+
+    void _release() {
+        if (!this->_local() && this->arena() == nullptr)
+            delete[] this->_heap;
+    }
+
+    void _check(const Binary& bin) const {
+        if (this->_size != bin._size)
+            throw std::invalid_argument("Binary sizes are not equal.");
+    }
 
 public:
     Binary() = delete;
 
-    // Copy constructor for vector using
+    // Copy constructor for vector using, copy goes to heap as it may outlive arena of source
     Binary(const Binary& bin): _size(bin._size) {
-        size_t pool_size = this->_size / 8 + 1;
-        this->_pool = new unsigned char[pool_size];
-        memcpy(this->_pool, bin._pool, pool_size);
+        this->_allocate();
+        memcpy(this->_data(), bin._data(), this->words() * sizeof(uint64_t));
+#ifdef CACHE_HASH
+        this->_hash.store(bin._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+    }
+
+    Binary(Binary&& bin) noexcept: _size(bin._size) {
+#ifdef CACHE_HASH
+        this->_hash.store(bin._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+        if (this->_local()) {
+            memcpy(this->_inline, bin._inline, sizeof(this->_inline));
+            return;
+        }
+        this->_heap = bin._heap;
+        bin._size = 0;
+    }
+
+    // Copy into arena storage, used by arena backed vectors so wide elements need no heap block each
+    explicit Binary(const Binary& bin, Arena* arena): _size(bin._size) {
+        this->_allocate(arena);
+        memcpy(this->_data(), bin._data(), this->words() * sizeof(uint64_t));
+#ifdef CACHE_HASH
+        this->_hash.store(bin._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
     }
 
     explicit Binary(size_t size): _size(size) {
-        size_t pool_size = size / 8 + 1;
-        this->_pool = new unsigned char[pool_size];
-        memset(this->_pool, 0, pool_size);
+        this->_allocate();
+    }
+
+    // Storage wider than inline bits comes from arena
+    explicit Binary(size_t size, Arena* arena): _size(size) {
+        this->_allocate(arena);
+    }
+
+    Binary& operator=(const Binary& bin) {
+        if (this == &bin)
+            return *this;
+        if (this->words() != bin.words()) {
+            Arena* arena = this->arena();
+            this->_release();
+            this->_size = bin._size;
+            this->_allocate(arena);
+        }
+        this->_size = bin._size;
+        memcpy(this->_data(), bin._data(), this->words() * sizeof(uint64_t));
+#ifdef CACHE_HASH
+        this->_hash.store(bin._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+        return *this;
+    }
+
+    Binary& operator=(Binary&& bin) noexcept {
+        if (this == &bin)
+            return *this;
+        this->_release();
+        this->_size = bin._size;
+#ifdef CACHE_HASH
+        this->_hash.store(bin._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+        if (this->_local()) {
+            memcpy(this->_inline, bin._inline, sizeof(this->_inline));
+            return *this;
+        }
+        this->_heap = bin._heap;
+        bin._size = 0;
+        return *this;
     }
 
     void set(int index, bool truth) {
-        if (index >= this->_size || index < 0)
+        if (index < 0 || static_cast<size_t>(index) >= this->_size)
             throw std::out_of_range("Invalid index");
 
-        size_t byte_offset = (this->_size - index - 1) / 8;
-        unsigned char* target = this->_pool + byte_offset;
-        size_t offset = (this->_size - index) - byte_offset * 8;
-
-        unsigned char bit = 0x01 << (8 - offset);
+        uint64_t bit = 1ull << (index % WORD_BITS);
+        uint64_t& word = this->_data()[index / WORD_BITS];
         if (truth)
-            *target |= bit;
+            word |= bit;
         else
-            *target &= ~bit;
+            word &= ~bit;
     }
 
     bool get(size_t index) const {
-        if (index >= this->size() || index < 0)
+        if (index >= this->_size)
             throw std::out_of_range("Invalid index");
+        return (this->_data()[index / WORD_BITS] >> (index % WORD_BITS)) & 1u;
+    }
 
-        size_t byte_offset = (this->_size - index - 1) / 8;
-        unsigned char* target = this->_pool + byte_offset;
-        size_t offset = (this->_size - index) - byte_offset * 8;
-
-        unsigned char bit = 0x01 << (8 - offset);
-        return static_cast<bool>((*target & bit) >> (8 - offset));
+    void flip(size_t index) {
+        if (index >= this->_size)
+            throw std::out_of_range("Invalid index");
+        this->_data()[index / WORD_BITS] ^= 1ull << (index % WORD_BITS);
     }
 
-    long decimal() const {
-        long value = 0;
-        for (size_t _ = 0; _ < this->_size; _++) {
-            if (this->get(_))
-                value += 1u << _;
-        }
-        return value;
+    // Lowest 64 bits as unsigned value
+    uint64_t decimal() const {
+        if (this->_size == 0)
+            return 0;
+        return this->_data()[0];
     }
 
     template <typename VT>
     void decimal(VT value) {
-        auto ulconv = static_cast<unsigned long>(value);
-        for (size_t power = 0; power < this->_size; power ++) {
-            if (static_cast<bool>(ulconv & 1u << power))
-                this->set(power, true);
-            else
-                this->set(power, false);
-        }
+        uint64_t* data = this->_data();
+        size_t count = this->words();
+        if (count == 0)
+            return;
+
+        memset(data, 0, count * sizeof(uint64_t));
+        data[0] = static_cast<unsigned long long>(value);
+        if (count == 1)
+            data[0] &= this->_mask();
     }
 
     size_t size() const { return this->_size; }
-    ~Binary() { delete this->_pool; }
+
+    Arena* arena() const {
+        if (this->_local())
+            return nullptr;
+        return reinterpret_cast<Arena*>(static_cast<uintptr_t>(this->_heap[0]));
+    }
+    size_t words() const { return (this->_size + WORD_BITS - 1) / WORD_BITS; }
+
+    uint64_t word(size_t index) const {
+        if (index >= this->words())
+            throw std::out_of_range("Invalid word index");
+        return this->_data()[index];
+    }
+
+    void word(size_t index, uint64_t value) {
+        if (index >= this->words())
+            throw std::out_of_range("Invalid word index");
+        if (index == this->words() - 1)
+            value &= this->_mask();
+        this->_data()[index] = value;
+    }
+
+    size_t popcount() const {
+        const uint64_t* data = this->_data();
+        size_t count = 0;
+        for (size_t _ = 0; _ < this->words(); _++)
+            count += ::popcount(data[_]);
+        return count;
+    }
+
+    uint64_t hash() const {
+#ifdef CACHE_HASH
+        const uint64_t cached = this->_hash.load(std::memory_order_relaxed);
+        if (cached != 0)
+            return cached;
+#endif
+        const uint64_t* data = this->_data();
+        uint64_t value = mix(this->_size);
+        for (size_t _ = 0; _ < this->words(); _++)
+            value = mix(value ^ data[_]);
+#ifdef CACHE_HASH
+        this->_hash.store(value, std::memory_order_relaxed);
+#endif
+        return value;
+    }
+
+    Binary& operator^=(const Binary& bin) {
+        this->_check(bin);
+        uint64_t* data = this->_data();
+        const uint64_t* other = bin._data();
+        for (size_t _ = 0; _ < this->words(); _++)
+            data[_] ^= other[_];
+        return *this;
+    }
+
+    Binary& operator&=(const Binary& bin) {
+        this->_check(bin);
+        uint64_t* data = this->_data();
+        const uint64_t* other = bin._data();
+        for (size_t _ = 0; _ < this->words(); _++)
+            data[_] &= other[_];
+        return *this;
+    }
+
+    Binary& operator|=(const Binary& bin) {
+        this->_check(bin);
+        uint64_t* data = this->_data();
+        const uint64_t* other = bin._data();
+        for (size_t _ = 0; _ < this->words(); _++)
+            data[_] |= other[_];
+        return *this;
+    }
+
+    // Shift towards most significant bit, bits moved past size are dropped
+    Binary& operator<<=(size_t count) {
+        uint64_t* data = this->_data();
+        const size_t total = this->words();
+        const size_t shift = count / WORD_BITS;
+        const size_t offset = count % WORD_BITS;
+        for (size_t _ = total; _-- > 0;) {
+            uint64_t value = 0;
+            if (_ >= shift) {
+                value = data[_ - shift] << offset;
+                if (offset != 0 && _ > shift)
+                    value |= data[_ - shift - 1] >> (WORD_BITS - offset);
+            }
+            data[_] = value;
+        }
+        if (total != 0)
+            data[total - 1] &= this->_mask();
+        return *this;
+    }
+
+    Binary& operator>>=(size_t count) {
+        uint64_t* data = this->_data();
+        const size_t total = this->words();
+        const size_t shift = count / WORD_BITS;
+        const size_t offset = count % WORD_BITS;
+        for (size_t _ = 0; _ < total; _++) {
+            uint64_t value = 0;
+            if (_ + shift < total) {
+                value = data[_ + shift] >> offset;
+                if (offset != 0 && _ + shift + 1 < total)
+                    value |= data[_ + shift + 1] << (WORD_BITS - offset);
+            }
+            data[_] = value;
+        }
+        return *this;
+    }
+
+    Binary operator~() const {
+        Binary result(*this);
+        uint64_t* data = result._data();
+        for (size_t _ = 0; _ < result.words(); _++)
+            data[_] = ~data[_];
+        if (result.words() != 0)
+            data[result.words() - 1] &= result._mask();
+        return result;
+    }
+
+    ~Binary() { this->_release(); }
     friend std::ostream& operator<<(std::ostream&, const Binary&);
-    friend bool operator==(const Binary&, const Binary&);
+
+    friend bool operator==(const Binary& bina, const Binary& binb) {
+        if (bina._size != binb._size)
+            return false;
+        return memcmp(bina._data(), binb._data(), bina.words() * sizeof(uint64_t)) == 0;
+    }
+
+    friend bool operator!=(const Binary& bina, const Binary& binb) {
+        return !(bina == binb);
+    }
+
+    // Order by size first, then by value from most significant word
+    friend bool operator<(const Binary& bina, const Binary& binb) {
+        if (bina._size != binb._size)
+            return bina._size < binb._size;
+        const uint64_t* dataa = bina._data();
+        const uint64_t* datab = binb._data();
+        for (size_t _ = bina.words(); _-- > 0;)
+            if (dataa[_] != datab[_])
+                return dataa[_] < datab[_];
+        return false;
+    }
 };
 
+inline Binary operator^(Binary bina, const Binary& binb) { return bina ^= binb; }
+inline Binary operator&(Binary bina, const Binary& binb) { return bina &= binb; }
+inline Binary operator|(Binary bina, const Binary& binb) { return bina |= binb; }
+inline Binary operator<<(Binary bin, size_t count) { return bin <<= count; }
+inline Binary operator>>(Binary bin, size_t count) { return bin >>= count; }
+
+// Binary and derived codes copy their wide storage into arena of vector holding them
+template <typename T>
+struct ArenaCopy<T, typename std::enable_if<std::is_base_of<Binary, T>::value>::type>: std::true_type {};
+
 #endif //GRAYSET_BINARY_H
@@ -0,0 +1,67 @@
+#ifndef GRAYSET_BITS_H
+#define GRAYSET_BITS_H
+
+#include "header.h"
+
+#include <cstdint>
+
+// Word level helpers, builtins when compiler provides them
+inline unsigned int popcount(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<unsigned int>((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Count trailing zeros, word must not be zero
+inline unsigned int ctz(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctzll(word));
+#else
+    unsigned int count = 0;
+    while (!(word & 1u)) {
+        word >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Count leading zeros, word must not be zero
+inline unsigned int clz(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_clzll(word));
+#else
+    unsigned int count = 0;
+    while (!(word >> 63)) {
+        word <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Hint cache to load address soon, nothing happens without compiler support
+inline void prefetch(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void) address;
+#endif
+}
+
+// Finalizer of SplitMix64, every input bit affects every output bit
+inline uint64_t mix(uint64_t word) {
+    word ^= word >> 30;
+    word *= 0xbf58476d1ce4e5b9ull;
+    word ^= word >> 27;
+    word *= 0x94d049bb133111ebull;
+    word ^= word >> 31;
+    return word;
+}
+
+#endif //GRAYSET_BITS_H
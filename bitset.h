@@ -0,0 +1,221 @@
+#ifndef GRAYSET_BITSET_H
+#define GRAYSET_BITSET_H
+
+#include "header.h"
+#include "bits.h"
+#include "gray.h"
+#include "vector.h"
+#include "set.h"
+
+// Set of Gray codes with same power kept as bitmap over whole 2^power universe
+class BitSet {
+public:
+    static const unsigned int MAX_POWER = 32;
+
+private:
+    static const size_t WORD_BITS = 64;
+
+    unsigned int _power;
+    size_t _count;
+    Vector<uint64_t> _words;
+
+    // Mask of valid bits in last word
+    uint64_t _mask() const {
+        uint64_t bits = 1ull << this->_power;
+        return bits >= WORD_BITS ? ~0ull : (1ull << bits) - 1;
+    }
+
+    void _check(const BitSet& other) const {
+        if (this->_power != other._power)
+            throw std::invalid_argument("Powers of bit sets are not equal.");
+    }
+
+    size_t _recount() const {
+        size_t count = 0;
+        for (const auto word: this->_words)
+            count += popcount(word);
+        return count;
+    }
+
+    // Word wise operation, loops are kept plain so compiler can vectorize them
+    template <typename Operation>
+    BitSet _combine(const BitSet& other, Operation operation) const {
+        this->_check(other);
+        BitSet result(this->_power);
+        const uint64_t* __restrict a = this->_words.data();
+        const uint64_t* __restrict b = other._words.data();
+        uint64_t* __restrict target = result._words.data();
+        const size_t words = this->_words.count();
+        for (size_t _ = 0; _ < words; _++)
+            target[_] = operation(a[_], b[_]);
+        result._count = result._recount();
+        return result;
+    }
+
+public:
+    BitSet() = delete;
+    explicit BitSet(unsigned int power): _power(power), _count(0) {
+        if (power > MAX_POWER)
+            throw std::range_error("Power of bit set must not exceed 32.");
+        this->_words.resize(((1ull << power) + WORD_BITS - 1) / WORD_BITS, 0);
+    }
+
+    explicit BitSet(unsigned int power, const Set<Gray>& set): BitSet(power) {
+        for (const auto& value: set)
+            this->add(value);
+    }
+
+    static BitSet universal(unsigned int power) {
+        BitSet result(power);
+        for (auto& word: result._words)
+            word = ~0ull;
+        result._words[result._words.count() - 1] &= result._mask();
+        result._count = 1ull << power;
+        return result;
+    }
+
+    inline size_t count() const { return this->_count; }
+    unsigned int power() const { return this->_power; }
+
+    // Raw bitmap, bit of code c is bit c % 64 of word c / 64
+    size_t words() const { return this->_words.count(); }
+    const uint64_t* data() const { return this->_words.data(); }
+    bool multiple() const { return false; }
+
+    void add(uint64_t code) {
+        if (code >> this->_power)
+            throw std::out_of_range("Code is out of bit set universe.");
+        uint64_t& word = this->_words[code / WORD_BITS];
+        uint64_t bit = 1ull << (code % WORD_BITS);
+        this->_count += !(word & bit);
+        word |= bit;
+    }
+
+    void remove(uint64_t code) {
+        if (code >> this->_power)
+            return;
+        uint64_t& word = this->_words[code / WORD_BITS];
+        uint64_t bit = 1ull << (code % WORD_BITS);
+        this->_count -= !!(word & bit);
+        word &= ~bit;
+    }
+
+    bool in(uint64_t code) const {
+        if (code >> this->_power)
+            return false;
+        return (this->_words[code / WORD_BITS] >> (code % WORD_BITS)) & 1u;
+    }
+
+    void add(const Gray& value) {
+        if (value.size() != this->_power)
+            throw std::invalid_argument("Gray size is not equal to power of bit set.");
+        this->add(value.decimal());
+    }
+
+    void remove(const Gray& value) {
+        if (value.size() == this->_power)
+            this->remove(value.decimal());
+    }
+
+    bool in(const Gray& value) const {
+        return value.size() == this->_power && this->in(value.decimal());
+    }
+
+    // Back to hash based set, elements in ascending code order
+    Set<Gray> set() const {
+        Set<Gray> result(1);
+        result.reserve(this->_count);
+        for (const auto& value: *this)
+            result.add(value);
+        return result;
+    }
+
+public:
+    class Iterator {
+    private:
+        const uint64_t* _words;
+        size_t _index;
+        size_t _total;
+        uint64_t _rest;
+        unsigned int _power;
+
+        // Move to next word that still has bits
+        void _skip() {
+            while (this->_rest == 0 && ++this->_index < this->_total)
+                this->_rest = this->_words[this->_index];
+        }
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(const uint64_t* words, size_t index, size_t total, unsigned int power):
+        _words(words), _index(index), _total(total), _rest(0), _power(power) {
+            if (this->_index < this->_total) {
+                this->_rest = this->_words[this->_index];
+                this->_skip();
+            }
+        };
+
+        uint64_t code() const {
+            return this->_index * WORD_BITS + ctz(this->_rest);
+        }
+
+        Gray operator*() const {
+            Gray gray(this->_power);
+            gray.decimal(this->code());
+            return gray;
+        }
+
+        Iterator operator++() {
+            this->_rest &= this->_rest - 1;
+            this->_skip();
+            return *this;
+        }
+
+        bool operator!=(const BitSet::Iterator& iter) const {
+            return this->_index != iter._index || this->_rest != iter._rest;
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(this->_words.data(), 0, this->_words.count(), this->_power);
+    }
+    Iterator end() const {
+        return Iterator(this->_words.data(), this->_words.count(), this->_words.count(), this->_power);
+    }
+
+public:
+
+    // All arithmetic operations
+    BitSet intersection(const BitSet& other) const {
+        return this->_combine(other, [](uint64_t a, uint64_t b) { return a & b; });
+    }
+
+    BitSet union_(const BitSet& other) const {
+        return this->_combine(other, [](uint64_t a, uint64_t b) { return a | b; });
+    }
+
+    BitSet difference(const BitSet& other) const {
+        return this->_combine(other, [](uint64_t a, uint64_t b) { return a & ~b; });
+    }
+
+    BitSet symdiff(const BitSet& other) const {
+        return this->_combine(other, [](uint64_t a, uint64_t b) { return a ^ b; });
+    }
+
+    // Universe is implied by power, no universal set is needed
+    BitSet complement() const {
+        BitSet result(this->_power);
+        const size_t words = this->_words.count();
+        for (size_t _ = 0; _ < words; _++)
+            result._words[_] = ~this->_words[_];
+        result._words[words - 1] &= this->_mask();
+        result._count = (1ull << this->_power) - this->_count;
+        return result;
+    }
+
+    BitSet complement(const BitSet& universal) const {
+        return universal.difference(*this);
+    }
+};
+
+#endif //GRAYSET_BITSET_H
@@ -0,0 +1,138 @@
+#include "codec.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAYSET_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*Kernel)(const uint64_t*, uint64_t*, size_t);
+
+static void encode_scalar(const uint64_t* values, uint64_t* codes, size_t count) {
+    for (size_t _ = 0; _ < count; _++)
+        codes[_] = encode(values[_]);
+}
+
+static void decode_scalar(const uint64_t* codes, uint64_t* values, size_t count) {
+    for (size_t _ = 0; _ < count; _++)
+        values[_] = decode(codes[_]);
+}
+
+#ifdef GRAYSET_X86
+__attribute__((target("sse2")))
+static void encode_sse2(const uint64_t* values, uint64_t* codes, size_t count) {
+    size_t index = 0;
+    for (; index + 2 <= count; index += 2) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + index));
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + index), value);
+    }
+    encode_scalar(values + index, codes + index, count - index);
+}
+
+__attribute__((target("sse2")))
+static void decode_sse2(const uint64_t* codes, uint64_t* values, size_t count) {
+    size_t index = 0;
+    for (; index + 2 <= count; index += 2) {
+        __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + index));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 1));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 2));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 4));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 8));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 16));
+        code = _mm_xor_si128(code, _mm_srli_epi64(code, 32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + index), code);
+    }
+    decode_scalar(codes + index, values + index, count - index);
+}
+
+__attribute__((target("avx2")))
+static void encode_avx2(const uint64_t* values, uint64_t* codes, size_t count) {
+    size_t index = 0;
+    for (; index + 4 <= count; index += 4) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + index));
+        value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + index), value);
+    }
+    encode_scalar(values + index, codes + index, count - index);
+}
+
+__attribute__((target("avx2")))
+static void decode_avx2(const uint64_t* codes, uint64_t* values, size_t count) {
+    size_t index = 0;
+    for (; index + 4 <= count; index += 4) {
+        __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(codes + index));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 1));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 2));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 4));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 8));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 16));
+        code = _mm256_xor_si256(code, _mm256_srli_epi64(code, 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + index), code);
+    }
+    decode_scalar(codes + index, values + index, count - index);
+}
+#endif
+
+// Pick best supported kernels once
+struct Dispatch {
+    Kernel encode;
+    Kernel decode;
+    const char* name;
+
+    Dispatch(): encode(encode_scalar), decode(decode_scalar), name("scalar") {
+#ifdef GRAYSET_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            this->encode = encode_avx2;
+            this->decode = decode_avx2;
+            this->name = "avx2";
+        } else if (__builtin_cpu_supports("sse2")) {
+            this->encode = encode_sse2;
+            this->decode = decode_sse2;
+            this->name = "sse2";
+        }
+#endif
+    }
+};
+
+static const Dispatch& dispatch() {
+    static const Dispatch instance;
+    return instance;
+}
+
+void encode(const uint64_t* values, uint64_t* codes, size_t count) {
+    dispatch().encode(values, codes, count);
+}
+
+void decode(const uint64_t* codes, uint64_t* values, size_t count) {
+    dispatch().decode(codes, values, count);
+}
+
+Vector<Gray> encode(const uint64_t* values, size_t count, unsigned int power) {
+    Vector<Gray> result;
+    result.reserve(count);
+
+    // Convert in fixed blocks so the SIMD kernel runs on a stack buffer
+    const size_t block = 256;
+    uint64_t codes[block];
+    for (size_t index = 0; index < count; index += block) {
+        size_t size = std::min(block, count - index);
+        encode(values + index, codes, size);
+        for (size_t _ = 0; _ < size; _++)
+            result.emplace(power).decimal(codes[_]);
+    }
+    return result;
+}
+
+void decode(const Vector<Gray>& codes, uint64_t* values) {
+    for (size_t _ = 0; _ < codes.count(); _++) {
+        if (codes[_].size() > 64)
+            throw std::range_error("Only Gray codes up to 64 bits can be decoded.");
+        values[_] = codes[_].decimal();
+    }
+    decode(values, values, codes.count());
+}
+
+const char* kernel() {
+    return dispatch().name;
+}
@@ -0,0 +1,19 @@
+#ifndef GRAYSET_CODEC_H
+#define GRAYSET_CODEC_H
+
+#include "header.h"
+#include "gray.h"
+#include "vector.h"
+
+// Bulk kernels, SIMD path is chosen once at runtime with scalar fallback
+void encode(const uint64_t* values, uint64_t* codes, size_t count);
+void decode(const uint64_t* codes, uint64_t* values, size_t count);
+
+// Bulk conversion from and to Gray objects of given power
+Vector<Gray> encode(const uint64_t* values, size_t count, unsigned int power);
+void decode(const Vector<Gray>& codes, uint64_t* values);
+
+// Name of kernel selected for this machine
+const char* kernel();
+
+#endif //GRAYSET_CODEC_H
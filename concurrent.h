@@ -0,0 +1,167 @@
+#ifndef GRAYSET_CONCURRENT_H
+#define GRAYSET_CONCURRENT_H
+
+#include "header.h"
+#include "set.h"
+#include "bits.h"
+
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+
+// Set split into independently locked stripes, stripe of value is chosen by its hash
+template <typename T, typename H = Hash<T>>
+class ConcurrentSet {
+private:
+    // Each stripe on own cache line so writers of different stripes do not share lines
+    struct alignas(64) Stripe {
+        mutable std::shared_mutex lock;
+        Set<T, H> set;
+
+        Stripe(size_t slots, bool unique, float load): set(slots, unique, load) {}
+    };
+
+    size_t _stripes;
+    Stripe* _data;
+    H _hasher;
+    bool _unique;
+
+    // Hash is mixed once more so stripe does not depend on slot or fingerprint bits
+    Stripe& _stripe(uint64_t hash) const {
+        return this->_data[mix(hash) & (this->_stripes - 1)];
+    }
+
+    // Stripes are built in place, so only constructed ones are destroyed
+    void _destroy(size_t built) {
+        for (size_t _ = 0; _ < built; _++)
+            this->_data[_].~Stripe();
+        ::operator delete[](this->_data, std::align_val_t(alignof(Stripe)));
+    }
+
+    static size_t _round(size_t stripes) {
+        size_t size = 1;
+        while (size < stripes)
+            size <<= 1;
+        return size;
+    }
+
+public:
+    ConcurrentSet() = delete;
+    ConcurrentSet(const ConcurrentSet<T, H>& set) = delete;
+    ConcurrentSet<T, H>& operator=(const ConcurrentSet<T, H>& set) = delete;
+
+    // Zero stripes means four per hardware thread, slots are spread over stripes
+    explicit ConcurrentSet(size_t slots, bool unique = true, unsigned int stripes = 0, float load = 0.875f):
+    _stripes(0), _data(nullptr), _unique(unique) {
+        if (slots <= 0)
+            throw std::range_error("Number of slots must greater than 0.");
+        if (stripes == 0)
+            stripes = 4 * std::max(1u, std::thread::hardware_concurrency());
+
+        this->_stripes = _round(stripes);
+        this->_data = static_cast<Stripe*>(::operator new[](sizeof(Stripe) * this->_stripes, std::align_val_t(alignof(Stripe))));
+        const size_t each = std::max<size_t>(1, slots / this->_stripes);
+        size_t built = 0;
+        try {
+            for (; built < this->_stripes; built++)
+                new (&this->_data[built]) Stripe(each, unique, load);
+        } catch (...) {
+            this->_destroy(built);
+            throw;
+        }
+    }
+
+    size_t stripes() const { return this->_stripes; }
+
+    bool multiple() const { return not this->_unique; }
+
+    // Sum over stripes, exact only while no writer is running
+    size_t count() const {
+        size_t count = 0;
+        for (size_t _ = 0; _ < this->_stripes; _++) {
+            std::shared_lock<std::shared_mutex> guard(this->_data[_].lock);
+            count += this->_data[_].set.count();
+        }
+        return count;
+    }
+
+    void reserve(size_t count) {
+        const size_t each = count / this->_stripes + 1;
+        for (size_t _ = 0; _ < this->_stripes; _++) {
+            std::unique_lock<std::shared_mutex> guard(this->_data[_].lock);
+            this->_data[_].set.reserve(each);
+        }
+    }
+
+    // Hashing is done before taking lock, so lock is held only for table update
+    void add(const T& value) {
+        const uint64_t hash = this->_hasher(value);
+        Stripe& stripe = this->_stripe(hash);
+        std::unique_lock<std::shared_mutex> guard(stripe.lock);
+        stripe.set._add(value, hash);
+    }
+
+    void remove(const T& value) {
+        Stripe& stripe = this->_stripe(this->_hasher(value));
+        std::unique_lock<std::shared_mutex> guard(stripe.lock);
+        stripe.set.remove(value);
+    }
+
+    // Readers share stripe lock, they only wait for a writer of same stripe
+    bool in(const T& value) const {
+        const uint64_t hash = this->_hasher(value);
+        Stripe& stripe = this->_stripe(hash);
+        std::shared_lock<std::shared_mutex> guard(stripe.lock);
+        return stripe.set._contains(value, hash);
+    }
+
+    unsigned int multiplicity(const T& value) const {
+        const uint64_t hash = this->_hasher(value);
+        Stripe& stripe = this->_stripe(hash);
+        std::shared_lock<std::shared_mutex> guard(stripe.lock);
+        return stripe.set._multiplicity(value, hash);
+    }
+
+    // Values are hashed and grouped without locks, then each stripe is locked once
+    template <typename Iter>
+    void add_range(Iter begin, Iter end) {
+        Vector<Vector<T>> groups(this->_stripes, Vector<T>());
+        Vector<Vector<uint64_t>> hashes(this->_stripes, Vector<uint64_t>());
+        for (; begin != end; ++begin) {
+            T value(*begin);
+            const uint64_t hash = this->_hasher(value);
+            const size_t stripe = mix(hash) & (this->_stripes - 1);
+            groups[stripe].append(std::move(value));
+            hashes[stripe].append(hash);
+        }
+
+        for (size_t stripe = 0; stripe < this->_stripes; stripe++) {
+            if (groups[stripe].empty())
+                continue;
+            std::unique_lock<std::shared_mutex> guard(this->_data[stripe].lock);
+            Set<T, H>& set = this->_data[stripe].set;
+            set.reserve(set.distinct() + groups[stripe].count());
+            for (size_t _ = 0; _ < groups[stripe].count(); _++)
+                set._add(groups[stripe][_], hashes[stripe][_]);
+        }
+    }
+
+    // Copy into plain set, stripes hold different elements so nothing is looked up
+    Set<T, H> snapshot() const {
+        Set<T, H> result(1, this->_unique);
+        for (size_t _ = 0; _ < this->_stripes; _++) {
+            std::shared_lock<std::shared_mutex> guard(this->_data[_].lock);
+            const Set<T, H>& set = this->_data[_].set;
+            result.reserve(result.distinct() + set.distinct());
+            for (size_t position = 0; position < set.distinct(); position++)
+                result._append(set._elements[position], set._hashes[position], set._count(position));
+        }
+        return result;
+    }
+
+    ~ConcurrentSet() {
+        this->_destroy(this->_stripes);
+    }
+};
+
+#endif //GRAYSET_CONCURRENT_H
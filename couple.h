@@ -3,40 +3,83 @@
 
 #include "header.h"
 
+#include <tuple>
+#include <utility>
+
 template <typename Ta, typename Tb>
 class Couple {
 private:
-    Ta* _value_a;
-    Tb* _value_b;
+    Ta _value_a;
+    Tb _value_b;
 
 public:
     Couple() = delete;
-    explicit Couple(const Ta& valuea, const Tb& valueb) {
-        this->_value_a = new Ta(valuea);
-        this->_value_b = new Tb(valueb);
-    }
+    explicit Couple(const Ta& valuea, const Tb& valueb): _value_a(valuea), _value_b(valueb) {}
 
-    Couple(const Couple<Ta, Tb>& couple) {
-        this->_value_a = new Ta(*couple._value_a);
-        this->_value_b = new Tb(*couple._value_b);
-    }
+    // Construct members in place from any arguments they accept
+    template <typename Va, typename Vb>
+    explicit Couple(Va&& valuea, Vb&& valueb):
+        _value_a(std::forward<Va>(valuea)), _value_b(std::forward<Vb>(valueb)) {}
+
+    template <typename... Args_a, typename... Args_b>
+    explicit Couple(std::piecewise_construct_t, std::tuple<Args_a...> argsa, std::tuple<Args_b...> argsb):
+        _value_a(std::make_from_tuple<Ta>(std::move(argsa))),
+        _value_b(std::make_from_tuple<Tb>(std::move(argsb))) {}
+
+    Couple(const Couple<Ta, Tb>& couple) = default;
+    Couple(Couple<Ta, Tb>&& couple) = default;
+    Couple<Ta, Tb>& operator=(const Couple<Ta, Tb>& couple) = default;
+    Couple<Ta, Tb>& operator=(Couple<Ta, Tb>&& couple) = default;
+
+    Ta& first() { return this->_value_a; }
+    Tb& second() { return this->_value_b; }
+    const Ta& first() const { return this->_value_a; }
+    const Tb& second() const { return this->_value_b; }
 
-    Ta& first() const { return *this->_value_a; }
-    Tb& second() const { return *this-> _value_b; }
+    // Support for structured bindings
+    template <size_t N>
+    decltype(auto) get() const {
+        if constexpr (N == 0)
+            return this->first();
+        else
+            return this->second();
+    }
 
-    ~Couple() {
-        delete this->_value_a;
-        delete this->_value_b;
+    template <size_t N>
+    decltype(auto) get() {
+        if constexpr (N == 0)
+            return this->first();
+        else
+            return this->second();
     }
 
     friend std::ostream& operator<<(std::ostream& out, const Couple<Ta, Tb>& couple) {
-        std::cout << '(' << couple.first() << ", " << couple.second() << ')';
+        out << '(' << couple.first() << ", " << couple.second() << ')';
         return out;
     }
 
     friend bool operator==(const Couple<Ta, Tb>& couplea, const Couple<Ta, Tb>& coupleb) {
         return (couplea.first() == coupleb.first() && couplea.second() == coupleb.second());
     }
+
+    friend bool operator<(const Couple<Ta, Tb>& couplea, const Couple<Ta, Tb>& coupleb) {
+        if (couplea.first() < coupleb.first())
+            return true;
+        if (coupleb.first() < couplea.first())
+            return false;
+        return couplea.second() < coupleb.second();
+    }
 };
 
+namespace std {
+    template <typename Ta, typename Tb>
+    struct tuple_size<Couple<Ta, Tb>>: std::integral_constant<size_t, 2> {};
+
+    template <typename Ta, typename Tb>
+    struct tuple_element<0, Couple<Ta, Tb>> { typedef Ta type; };
+
+    template <typename Ta, typename Tb>
+    struct tuple_element<1, Couple<Ta, Tb>> { typedef Tb type; };
+}
+
 #endif //GRAYSET_COUPLE_H
@@ -0,0 +1,71 @@
+#ifndef GRAYSET_EXECUTOR_H
+#define GRAYSET_EXECUTOR_H
+
+#include "header.h"
+#include "vector.h"
+
+#include <thread>
+#include <exception>
+
+// Runs an index range split into contiguous chunks, one chunk per thread
+class Executor {
+private:
+    unsigned int _threads;
+    size_t _grain;
+
+public:
+    // Zero threads means one per hardware thread
+    explicit Executor(unsigned int threads = 0, size_t grain = 4096):
+    _threads(threads), _grain(grain) {
+        if (this->_threads == 0)
+            this->_threads = std::max(1u, std::thread::hardware_concurrency());
+        if (this->_grain == 0)
+            this->_grain = 1;
+    }
+
+    unsigned int threads() const { return this->_threads; }
+
+    // Number of chunks for given count, small ranges are not split below grain size
+    unsigned int shards(size_t count) const {
+        size_t shards = std::min<size_t>(this->_threads, (count + this->_grain - 1) / this->_grain);
+        return static_cast<unsigned int>(std::max<size_t>(shards, 1));
+    }
+
+    // Call task(shard, begin, end) for each chunk, caller thread runs last chunk
+    template <typename Task>
+    void run(size_t count, Task task) const {
+        const unsigned int shards = this->shards(count);
+        const size_t chunk = (count + shards - 1) / shards;
+        if (shards == 1) {
+            task(0u, static_cast<size_t>(0), count);
+            return;
+        }
+
+        Vector<std::exception_ptr> errors(shards, nullptr);
+        Vector<std::thread> workers;
+        workers.reserve(shards - 1);
+        for (unsigned int shard = 0; shard < shards; shard++) {
+            size_t begin = std::min(count, shard * chunk);
+            size_t end = std::min(count, begin + chunk);
+            auto body = [&task, &errors, shard, begin, end]() {
+                try {
+                    task(shard, begin, end);
+                } catch (...) {
+                    errors[shard] = std::current_exception();
+                }
+            };
+            if (shard + 1 == shards)
+                body();
+            else
+                workers.emplace(body);
+        }
+        for (auto& worker: workers)
+            worker.join();
+
+        for (const auto& error: errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+};
+
+#endif //GRAYSET_EXECUTOR_H
@@ -0,0 +1,212 @@
+#ifndef GRAYSET_FIXED_H
+#define GRAYSET_FIXED_H
+
+#include "header.h"
+#include "bits.h"
+#include "binary.h"
+#include "gray.h"
+#include "codec.h"
+
+#include <type_traits>
+
+// Smallest unsigned type holding N bits
+template <unsigned int N>
+using Narrow = typename std::conditional<N <= 8, uint8_t,
+               typename std::conditional<N <= 16, uint16_t,
+               typename std::conditional<N <= 32, uint32_t, uint64_t>::type>::type>::type;
+
+// Gray code and rank of every N bit value, filled at compile time
+template <unsigned int N>
+struct GrayTable {
+    static_assert(N >= 1 && N <= 16, "Gray table is only built for small widths.");
+
+    Narrow<N> codes[1u << N] = {};
+    Narrow<N> ranks[1u << N] = {};
+
+    constexpr GrayTable() {
+        for (uint64_t value = 0; value < (1ull << N); value++) {
+            this->codes[value] = static_cast<Narrow<N>>(encode(value));
+            this->ranks[encode(value)] = static_cast<Narrow<N>>(value);
+        }
+    }
+};
+
+template <unsigned int N>
+inline constexpr GrayTable<N> gray_table{};
+
+// Binary of width known at compile time, bits live inline in narrowest word
+template <unsigned int N>
+class FixedBinary {
+    static_assert(N >= 1 && N <= 64, "Width of fixed binary must between 1 and 64.");
+
+public:
+    typedef Narrow<N> Word;
+    static constexpr uint64_t MASK = ~0ull >> (64 - N);
+
+protected:
+    Word _word;
+
+public:
+    constexpr FixedBinary(): _word(0) {}
+    constexpr explicit FixedBinary(uint64_t value): _word(static_cast<Word>(value & MASK)) {}
+
+    explicit FixedBinary(const Binary& bin): _word(0) {
+        if (bin.size() != N)
+            throw std::invalid_argument("Binary sizes are not equal.");
+        this->_word = static_cast<Word>(bin.decimal());
+    }
+
+    static constexpr size_t size() { return N; }
+
+    constexpr uint64_t decimal() const { return this->_word; }
+
+    template <typename VT>
+    void decimal(VT value) {
+        this->_word = static_cast<Word>(static_cast<unsigned long long>(value) & MASK);
+    }
+
+    bool get(size_t index) const {
+        if (index >= N)
+            throw std::out_of_range("Invalid index");
+        return (this->_word >> index) & 1u;
+    }
+
+    void set(size_t index, bool truth) {
+        if (index >= N)
+            throw std::out_of_range("Invalid index");
+        if (truth)
+            this->_word |= static_cast<Word>(1ull << index);
+        else
+            this->_word &= static_cast<Word>(~(1ull << index));
+    }
+
+    void flip(size_t index) {
+        if (index >= N)
+            throw std::out_of_range("Invalid index");
+        this->_word ^= static_cast<Word>(1ull << index);
+    }
+
+    size_t popcount() const { return ::popcount(this->_word); }
+    uint64_t hash() const { return mix(this->_word); }
+
+    // Same bits as a runtime width binary
+    Binary binary() const {
+        Binary bin(N);
+        bin.decimal(this->_word);
+        return bin;
+    }
+
+    // Bits from most significant one, buffer needs room for N chars
+    size_t render(char* buffer) const {
+        for (unsigned int _ = 0; _ < N; _++)
+            buffer[_] = (this->_word >> (N - 1 - _)) & 1u ? '1' : '0';
+        return N;
+    }
+
+    FixedBinary& operator^=(const FixedBinary& bin) {
+        this->_word ^= bin._word;
+        return *this;
+    }
+
+    FixedBinary& operator&=(const FixedBinary& bin) {
+        this->_word &= bin._word;
+        return *this;
+    }
+
+    FixedBinary& operator|=(const FixedBinary& bin) {
+        this->_word |= bin._word;
+        return *this;
+    }
+
+    constexpr FixedBinary operator~() const { return FixedBinary(~static_cast<uint64_t>(this->_word)); }
+
+    friend constexpr bool operator==(const FixedBinary& bina, const FixedBinary& binb) {
+        return bina._word == binb._word;
+    }
+
+    friend constexpr bool operator!=(const FixedBinary& bina, const FixedBinary& binb) {
+        return bina._word != binb._word;
+    }
+
+    friend constexpr bool operator<(const FixedBinary& bina, const FixedBinary& binb) {
+        return bina._word < binb._word;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const FixedBinary& bin) {
+        char buffer[N];
+        return out.write(buffer, bin.render(buffer));
+    }
+};
+
+template <unsigned int N>
+FixedBinary<N> operator^(FixedBinary<N> bina, const FixedBinary<N>& binb) { return bina ^= binb; }
+template <unsigned int N>
+FixedBinary<N> operator&(FixedBinary<N> bina, const FixedBinary<N>& binb) { return bina &= binb; }
+template <unsigned int N>
+FixedBinary<N> operator|(FixedBinary<N> bina, const FixedBinary<N>& binb) { return bina |= binb; }
+
+template <unsigned int N>
+class FixedGray: public FixedBinary<N> {
+public:
+    // Widths up to this use inverse table, its two arrays stay within L1 cache
+    static const unsigned int TABLE_POWER = 12;
+
+    using FixedBinary<N>::FixedBinary;
+
+    // Code of rank, shift and xor is cheaper than a table load
+    static constexpr FixedGray encode(uint64_t rank) {
+        return FixedGray(::encode(rank & FixedBinary<N>::MASK));
+    }
+
+    // Rank of code
+    constexpr uint64_t decode() const {
+        if constexpr (N <= TABLE_POWER)
+            return gray_table<N>.ranks[this->_word];
+        else
+            return ::decode(this->_word);
+    }
+
+    template <typename VT>
+    void import(VT value) {
+        this->decimal(::encode(static_cast<unsigned long long>(value)));
+    }
+
+    // Same steps as Gray::next and Gray::prev on a single word
+    void next() {
+        uint64_t word = this->_word;
+        if (::popcount(word) % 2 == 0) {
+            word ^= 1u;
+        } else {
+            const unsigned int lowest = ctz(word);
+            word ^= 1ull << (lowest + 1 < N ? lowest + 1 : lowest);
+        }
+        this->_word = static_cast<typename FixedBinary<N>::Word>(word);
+    }
+
+    void prev() {
+        uint64_t word = this->_word;
+        if (::popcount(word) % 2 == 1)
+            word ^= 1u;
+        else
+            word ^= word == 0 ? 1ull << (N - 1) : 1ull << (ctz(word) + 1);
+        this->_word = static_cast<typename FixedBinary<N>::Word>(word);
+    }
+
+    Gray gray() const {
+        Gray gray(N);
+        gray.decimal(this->_word);
+        return gray;
+    }
+};
+
+// Lets writers render fixed codes directly
+template <typename T>
+struct IsFixed: std::false_type {};
+
+template <unsigned int N>
+struct IsFixed<FixedBinary<N>>: std::true_type {};
+
+template <unsigned int N>
+struct IsFixed<FixedGray<N>>: std::true_type {};
+
+#endif //GRAYSET_FIXED_H
@@ -0,0 +1,122 @@
+#include "format.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+// Eight chars of every byte value, most significant bit first
+struct Table {
+    char chars[256][8];
+
+    Table(): chars() {
+        for (unsigned int byte = 0; byte < 256; byte++)
+            for (unsigned int bit = 0; bit < 8; bit++)
+                this->chars[byte][bit] = (byte >> (7 - bit)) & 1u ? '1' : '0';
+    }
+};
+
+static const Table table;
+
+size_t render(const Binary& bin, char* buffer) {
+    char* out = buffer;
+    for (size_t index = bin.words(); index-- > 0;) {
+        const uint64_t word = bin.word(index);
+        const size_t bits = index == bin.words() - 1 ? bin.size() - index * 64 : 64;
+
+        // Leading bits of a partial byte, then whole bytes from table
+        size_t bit = bits;
+        while (bit % 8 != 0) {
+            bit--;
+            *out++ = (word >> bit) & 1u ? '1' : '0';
+        }
+        while (bit != 0) {
+            bit -= 8;
+            memcpy(out, table.chars[(word >> bit) & 0xffu], 8);
+            out += 8;
+        }
+    }
+    return out - buffer;
+}
+
+size_t render(uint64_t value, char* buffer) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (size_t _ = 0; _ < count; _++)
+        buffer[_] = digits[count - 1 - _];
+    return count;
+}
+
+Writer::Writer(int fd): _fd(fd), _owner(false), _size(0), _buffer(new char[BUFFER]) {}
+
+Writer::Writer(const char* path): _fd(-1), _owner(true), _size(0), _buffer(nullptr) {
+    this->_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (this->_fd < 0)
+        throw std::runtime_error(std::string("Can not open file ") + path);
+    this->_buffer = new char[BUFFER];
+}
+
+void Writer::write(const char* data, size_t count) {
+    if (count == 0)
+        return;
+    if (this->_size + count <= BUFFER) {
+        memcpy(this->_buffer + this->_size, data, count);
+        this->_size += count;
+        return;
+    }
+
+    // Data bigger than free room fills buffer piece by piece
+    while (count != 0) {
+        size_t piece = std::min(count, BUFFER - this->_size);
+        memcpy(this->_buffer + this->_size, data, piece);
+        this->_size += piece;
+        data += piece;
+        count -= piece;
+        if (this->_size == BUFFER)
+            this->flush();
+    }
+}
+
+void Writer::flush() {
+    size_t done = 0;
+    while (done < this->_size) {
+        ssize_t written = ::write(this->_fd, this->_buffer + done, this->_size - done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            this->_size = 0;
+            throw std::runtime_error("Can not write output.");
+        }
+        done += written;
+    }
+    this->_size = 0;
+}
+
+Writer& Writer::operator<<(const Binary& bin) {
+    if (bin.size() <= BUFFER) {
+        this->_size += render(bin, this->_room(bin.size()));
+        return *this;
+    }
+    std::string text(bin.size(), '0');
+    render(bin, &text[0]);
+    return *this << text;
+}
+
+// Errors are only reported by explicit flush, destructor must not throw
+Writer::~Writer() {
+    try {
+        this->flush();
+    } catch (...) {}
+    delete[] this->_buffer;
+    if (this->_owner)
+        close(this->_fd);
+}
+
+Writer& console() {
+    static Writer writer(STDOUT_FILENO);
+    std::cout.flush();
+    return writer;
+}
@@ -0,0 +1,107 @@
+#ifndef GRAYSET_FORMAT_H
+#define GRAYSET_FORMAT_H
+
+#include "header.h"
+#include "binary.h"
+#include "couple.h"
+#include "fixed.h"
+
+#include <sstream>
+#include <type_traits>
+
+// Write bits of binary into buffer from most significant bit, returns number of chars
+size_t render(const Binary& bin, char* buffer);
+
+// Decimal digits of value into buffer, returns number of chars
+size_t render(uint64_t value, char* buffer);
+
+// Buffered sink over a file descriptor, nothing is written until buffer is full or flushed
+class Writer {
+public:
+    static const size_t BUFFER = 1u << 16;
+
+private:
+    int _fd;
+    bool _owner;
+    size_t _size;
+    char* _buffer;
+
+    // Free room for at least given number of chars
+    char* _room(size_t count) {
+        if (this->_size + count > BUFFER)
+            this->flush();
+        return this->_buffer + this->_size;
+    }
+
+public:
+    Writer() = delete;
+    Writer(const Writer& writer) = delete;
+    Writer& operator=(const Writer& writer) = delete;
+
+    explicit Writer(int fd);
+
+    // Create or truncate file, descriptor is closed with writer
+    explicit Writer(const char* path);
+
+    int fd() const { return this->_fd; }
+
+    void write(const char* data, size_t count);
+
+    // Throws runtime_error when descriptor does not take all data
+    void flush();
+
+    Writer& operator<<(char value) {
+        *this->_room(1) = value;
+        this->_size++;
+        return *this;
+    }
+
+    Writer& operator<<(const char* text) {
+        this->write(text, strlen(text));
+        return *this;
+    }
+
+    Writer& operator<<(const std::string& text) {
+        this->write(text.data(), text.size());
+        return *this;
+    }
+
+    // Wide codes go through the general write path in pieces
+    Writer& operator<<(const Binary& bin);
+
+    template <typename Ta, typename Tb>
+    Writer& operator<<(const Couple<Ta, Tb>& couple) {
+        return *this << '(' << couple.first() << ", " << couple.second() << ')';
+    }
+
+    // Binary derived types and integers are rendered directly, other types go through a stream
+    template <typename V>
+    Writer& operator<<(const V& value) {
+        if constexpr (std::is_base_of<Binary, V>::value) {
+            return *this << static_cast<const Binary&>(value);
+        } else if constexpr (IsFixed<V>::value) {
+            this->_size += value.render(this->_room(V::size()));
+            return *this;
+        } else if constexpr (std::is_integral<V>::value && std::is_unsigned<V>::value) {
+            this->_size += render(static_cast<uint64_t>(value), this->_room(20));
+            return *this;
+        } else if constexpr (std::is_integral<V>::value) {
+            if (value < 0)
+                *this << '-';
+            const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            this->_size += render(magnitude, this->_room(20));
+            return *this;
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            return *this << stream.str();
+        }
+    }
+
+    ~Writer();
+};
+
+// Shared writer on standard output, stream output is flushed first so order is kept
+Writer& console();
+
+#endif //GRAYSET_FORMAT_H
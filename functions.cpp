@@ -1,76 +1,58 @@
 #include "functions.h"
+#include "sampler.h"
 
-static std::default_random_engine engine(std::time(nullptr));
+static Random engine(std::time(nullptr));
 
-// Hash Template Function Specialization for Different Types of Values
-template <>
-unsigned int hash<Binary>(size_t maxsize, const Binary& bin) {
-    return bin.decimal() % maxsize;
-}
-
-template <>
-unsigned int hash<Gray>(size_t maxsize, const Gray& bin) {
-    return bin.decimal() % maxsize;
-}
-
-template <>
-unsigned int hash<char>(size_t maxsize, const char& chr) {
-    return chr % maxsize;
-}
-
-template <>
-unsigned int hash<Couple<char, char>>(size_t maxsize, const Couple<char, char>& couple) {
-    return hash(maxsize, (char)(couple.first() + couple.second()));
-}
-
-template <>
-unsigned int hash<Couple<Gray, Gray>>(size_t maxsize, const Couple<Gray, Gray>& couple) {
-    return (hash(maxsize, couple.first()) + hash(maxsize, couple.second())) % maxsize;
+void seed(uint64_t value) {
+    engine = Random(value);
 }
 
 // Friend functions for class Binary
 std::ostream& operator<<(std::ostream& out, const Binary& bin) {
-    for (size_t _ = bin.size() - 1; _ != 0; _--)
-        out << bin.get(_);
-    out << bin.get(0);
-    return out;
+    char local[Binary::INLINE_BITS];
+    if (bin.size() <= Binary::INLINE_BITS)
+        return out.write(local, render(bin, local));
+
+    std::string text(bin.size(), '0');
+    render(bin, &text[0]);
+    return out << text;
 }
 
-bool operator==(const Binary& bina, const Binary& binb) {
-    if (bina.size() != binb.size())
-        return false;
+void table(unsigned int power) {
+    Writer& out = console();
+    out << "Value" << '\t' << "Gray" << '\n';
+    out << "------------" << '\n';
+
+    // Test for power of Zero
+    if (power != 0) {
+        GraySequence sequence(power);
+        for (auto iter = sequence.begin(); iter != sequence.end(); ++iter)
+            out << iter.rank() << '\t' << iter.gray() << '\n';
+    }
 
-    for (size_t _ = 0; _ < bina._size; _++)
-        if (bina.get(_) != binb.get(_))
-            return false;
-    return true;
+    out << '\n';
+    out.flush();
 }
 
 Set<Gray> universal(unsigned int power) {
     Set<Gray> set(16, true);
-    std::cout << "Value" << '\t' << "Gray" << std::endl;
-    std::cout << "------------" << std::endl;
 
     // Test for power of Zero
-    if (power == 0) {
-        std::cout << std::endl;
+    if (power == 0)
         return set;
-    }
 
-    for (unsigned int value = 0; value < (0x1u << power); value++) {
-        Gray gray(power);
-        gray.import<short>(value);
-        std::cout << value << "\t" << gray << std::endl;
-        set.add(gray);
-    }
+    // Codes of a Gray sequence never repeat, so set is indexed without lookups
+    GraySequence sequence(power);
+    Vector<Gray> codes;
+    codes.reserve(sequence.count());
+    for (auto iter = sequence.begin(); iter != sequence.end(); ++iter)
+        codes.append(iter.gray());
+    set.add_range(std::move(codes), Set<Gray>::DISTINCT);
 
-    std::cout << std::endl;
     return set;
 }
 
 Set<Gray> random(unsigned int power, unsigned int cardinality, bool manual) {
-    std::uniform_int_distribution<unsigned> uniform(0, 0x1u << power);
-
 #ifdef MULTISET
     Set<Gray> set(16, false);
 #else
@@ -79,31 +61,35 @@ Set<Gray> random(unsigned int power, unsigned int cardinality, bool manual) {
 
     if (power == 0) return set;
     if (manual and cardinality == 0) return set;
+    if (power >= 64)
+        throw std::range_error("Power of random set must be below 64.");
+    const uint64_t universe = 0x1ull << power;
 
-    // When user not specified cardinality
+    // When user not specified cardinality, any size from empty set to whole universe
     if (not manual)
-        cardinality = uniform(engine);
+        cardinality = engine.below(std::min<uint64_t>(universe, std::numeric_limits<unsigned int>::max() - 1) + 1);
 
-    if (manual and set.multiple())
+    Vector<Gray> codes;
+    if (set.multiple()) {
+        codes.reserve(cardinality);
         for (unsigned int index = 0; index < cardinality; index++) {
             Gray gray(power);
-            gray.import<short>(uniform(engine));
-            set.add(gray);
-        }
-
-    if (manual and not set.multiple())
-        for (unsigned int value = 0; value < 0x1u << power && value < cardinality; value++) {
-            Gray gray(power);
-            gray.import<short>(value);
-            set.add(gray);
+            gray.import(engine.below(universe));
+            codes.append(std::move(gray));
         }
+        set.add_range(std::move(codes));
+        return set;
+    }
 
-    if (not manual)
-        for (unsigned int index = 0; index < cardinality; index++) {
-            Gray gray(power);
-            gray.import<short>(uniform(engine));
-            set.add(gray);
-        }
+    // Unique set gets exactly as many distinct codes as universe allows
+    const uint64_t count = std::min<uint64_t>(cardinality, universe);
+    codes.reserve(count);
+    floyd(power, count, engine, [&](uint64_t value) {
+        Gray gray(power);
+        gray.import(value);
+        codes.append(std::move(gray));
+    });
+    set.add_range(std::move(codes), Set<Gray>::DISTINCT);
 
     return set;
 }
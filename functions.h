@@ -6,72 +6,75 @@
 #include "binary.h"
 #include "gray.h"
 #include "couple.h"
+#include "bitset.h"
+#include "format.h"
 
-// Show all contents in HashSet
-template <typename T>
-void show(const char* label, const Set<T>& set, unsigned int line = 4) {
-    std::cout << label << ": {" << std::endl;
+// Show all elements of any set container, lines are batched in one buffered write
+template <typename S>
+void show_elements(Writer& out, const char* label, const S& set, unsigned int line) {
+    out << label << ": {" << '\n';
     unsigned int lc = line;
     auto size = set.count() - 1;
 
     // Detect empty set
     if (set.count() == 0) {
-        std::cout << '}' << std::endl;
+        out << '}' << '\n';
         return;
     }
 
-    for (auto value: set) {
+    for (const auto& value: set) {
         if (lc-- == line)
-            std::cout << '\t';
+            out << '\t';
 
-        std::cout << value;
+        out << value;
         if (size > 0)
-            std::cout << ", ";
+            out << ", ";
 
         if (lc == 0) {
             lc = line;
-            std::cout << std::endl;
+            out << '\n';
         }
         size--;
     }
     if (lc != line)
-        std::cout << std::endl;
-    std::cout << '}' << std::endl;
-
-    // Show multiset analysis
-    if (set.multiple()) {
-        std::cout << "Multiple set analysing: " << std::endl;
-        Vector<Couple<T, unsigned int>> result = set.analysis();
-
-        Couple<T, unsigned int> first = result.index(0);
-
-        T* mode = nullptr;
-        unsigned int most = 0;
-
-        unsigned int total = result.count();
-        for (int index = 0; index < total; index++) {
-            Couple<T, unsigned int> value = result.pop(0);
-            const T& element = value.first();
-            unsigned int count = value.second();
-            std::cout << element << " - " << count << " times" << std::endl;
+        out << '\n';
+    out << '}' << '\n';
+}
 
-            // Update moode and count
-            if (count > most) {
-                if (mode != nullptr) delete mode;
-                mode = new T(element);
-                most = count;
-            }
+// Show all contents in HashSet
+template <typename T, typename H>
+void show(const char* label, const Set<T, H>& set, unsigned int line = 4) {
+    Writer& out = console();
+    show_elements(out, label, set, line);
 
-        }
+    // Show multiset analysis
+    if (set.multiple() && set.count() != 0) {
+        out << "Multiple set analysing: " << '\n';
+        for (const auto& value: set.analysis())
+            out << value.first() << " - " << value.second() << " times" << '\n';
 
-        std::cout << "Mode element: " << *mode << " with " << most << " times" << std::endl;
-        std::cout << std::endl;
-        if (mode != nullptr) delete mode;
+        Couple<T, unsigned int> mode = set.mode();
+        out << "Mode element: " << mode.first() << " with " << mode.second() << " times" << '\n';
+        out << '\n';
     }
+    out.flush();
 }
 
+// Show all contents in bitmap set
+inline void show(const char* label, const BitSet& set, unsigned int line = 4) {
+    Writer& out = console();
+    show_elements(out, label, set, line);
+    out.flush();
+}
+
+// Print table of values and Gray codes with specific power
+void table(unsigned int);
+
 // Generate Gray Set with specific power
 Set<Gray> universal(unsigned int);
 Set<Gray> random(unsigned int, unsigned int = 0, bool usermode = false);
 
+// Restart generator of random sets, same seed gives same sets
+void seed(uint64_t);
+
 #endif //GRAYSET_FUNCTIONS_H
@@ -3,15 +3,181 @@
 
 #include "binary.h"
 
+// Scalar conversion between binary value and reflected Gray code
+constexpr uint64_t encode(uint64_t value) {
+    return value ^ (value >> 1);
+}
+
+// Inverse is prefix XOR of all higher bits, done in log steps
+constexpr uint64_t decode(uint64_t code) {
+    code ^= code >> 1;
+    code ^= code >> 2;
+    code ^= code >> 4;
+    code ^= code >> 8;
+    code ^= code >> 16;
+    code ^= code >> 32;
+    return code;
+}
+
 class Gray: public Binary {
+private:
+    // Index of lowest set bit, size when code is zero
+    size_t _lowest() const {
+        for (size_t _ = 0; _ < this->words(); _++) {
+            const uint64_t word = this->word(_);
+            if (word != 0)
+                return _ * 64 + ctz(word);
+        }
+        return this->size();
+    }
+
 public:
     using Binary::Binary;
 
 public:
     template <typename VT>
     void import(VT value) {
-        this->decimal<VT>(value ^ (value >> 1));
+        auto ullconv = static_cast<unsigned long long>(value);
+        this->decimal(ullconv ^ (ullconv >> 1));
+    }
+
+    // Step along reflected sequence in place, even parity flips lowest bit, odd flips bit above lowest set one
+    // Last code wraps around to first, they also differ in one bit
+    void next() {
+        if (this->size() == 0)
+            return;
+        if (this->popcount() % 2 == 0) {
+            this->flip(0);
+            return;
+        }
+        const size_t lowest = this->_lowest();
+        this->flip(lowest + 1 < this->size() ? lowest + 1 : lowest);
+    }
+
+    // Reverse of next, first code wraps around to last
+    void prev() {
+        if (this->size() == 0)
+            return;
+        if (this->popcount() % 2 == 1) {
+            this->flip(0);
+            return;
+        }
+        const size_t lowest = this->_lowest();
+        this->flip(lowest == this->size() ? this->size() - 1 : lowest + 1);
+    }
+
+    // Position in reflected sequence, wider codes have no integer rank
+    uint64_t rank() const {
+        if (this->size() > 64)
+            throw std::range_error("Rank of Gray wider than 64 bits does not fit.");
+        return decode(this->decimal());
+    }
+
+    void unrank(uint64_t index) {
+        this->decimal(encode(index));
+    }
+
+    // Steps between two codes along the sequence
+    uint64_t distance(const Gray& gray) const {
+        if (this->size() != gray.size())
+            throw std::invalid_argument("Gray sizes are not equal.");
+        const uint64_t ranka = this->rank();
+        const uint64_t rankb = gray.rank();
+        return ranka < rankb ? rankb - ranka : ranka - rankb;
+    }
+};
+
+// Orders codes by rank without decoding, codes of different size are ordered by size first
+struct GrayOrder {
+    // Ranks first differ at highest differing bit, there rank bit is parity of all code bits from it upwards
+    bool operator()(const Gray& graya, const Gray& grayb) const {
+        if (graya.size() != grayb.size())
+            return graya.size() < grayb.size();
+        unsigned int parity = 0;
+        for (size_t _ = graya.words(); _-- > 0;) {
+            const uint64_t worda = graya.word(_);
+            const uint64_t wordb = grayb.word(_);
+            if (worda != wordb) {
+                const unsigned int top = 63 - clz(worda ^ wordb);
+                return (parity ^ popcount(wordb >> top)) & 1u;
+            }
+            parity ^= popcount(worda);
+        }
+        return false;
+    }
+
+    // Fixed width codes decode in constant time
+    template <typename T>
+    bool operator()(const T& graya, const T& grayb) const {
+        return graya.decode() < grayb.decode();
+    }
+};
+
+// Reflected Gray sequence of ranks [start, stop), each step flips exactly one bit
+class GraySequence {
+private:
+    unsigned int _power;
+    uint64_t _start;
+    uint64_t _stop;
+
+public:
+    static const unsigned int MAX_POWER = 64;
+
+    class Iterator {
+    private:
+        unsigned int _power;
+        uint64_t _rank;
+        uint64_t _code;
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(unsigned int power, uint64_t rank):
+            _power(power), _rank(rank), _code(rank ^ (rank >> 1)) {};
+
+        uint64_t operator*() const { return this->_code; }
+        uint64_t rank() const { return this->_rank; }
+
+        Gray gray() const {
+            Gray gray(this->_power);
+            gray.decimal(this->_code);
+            return gray;
+        }
+
+        // Next code differs in the lowest set bit of next rank
+        Iterator& operator++() {
+            this->_rank++;
+            if (this->_rank != 0)
+                this->_code ^= 1ull << ctz(this->_rank);
+            return *this;
+        }
+
+        bool operator!=(const Iterator& iter) const {
+            return this->_rank != iter._rank;
+        }
+    };
+
+public:
+    GraySequence() = delete;
+
+    // Whole universe, for power 64 the last rank is left out as it can not be represented
+    explicit GraySequence(unsigned int power):
+        GraySequence(power, 0, power >= MAX_POWER ? ~0ull : 1ull << power) {};
+
+    explicit GraySequence(unsigned int power, uint64_t start, uint64_t stop):
+    _power(power), _start(start), _stop(stop) {
+        if (power > MAX_POWER)
+            throw std::range_error("Power of Gray sequence must not exceed 64.");
+        if (power < MAX_POWER && stop > 1ull << power)
+            throw std::range_error("Stop rank is out of Gray universe.");
+        if (start > stop)
+            throw std::range_error("Start rank must not exceed stop rank.");
     }
+
+    unsigned int power() const { return this->_power; }
+    uint64_t count() const { return this->_stop - this->_start; }
+
+    Iterator begin() const { return Iterator(this->_power, this->_start); }
+    Iterator end() const { return Iterator(this->_power, this->_stop); }
 };
 
 #endif //GRAYSET_GRAY_H
@@ -0,0 +1,54 @@
+#ifndef GRAYSET_HASH_H
+#define GRAYSET_HASH_H
+
+#include "header.h"
+#include "bits.h"
+#include "binary.h"
+#include "gray.h"
+#include "fixed.h"
+#include "couple.h"
+
+#include <type_traits>
+
+// Hash functors give full 64 bit values, tables mask them to their own size
+template <typename T>
+struct Hash {
+    uint64_t operator()(const T& value) const {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                      "No Hash specialization for this type.");
+        return mix(static_cast<uint64_t>(value));
+    }
+};
+
+template <>
+struct Hash<Binary> {
+    uint64_t operator()(const Binary& bin) const {
+        return bin.hash();
+    }
+};
+
+template <>
+struct Hash<Gray>: public Hash<Binary> {};
+
+// Fixed width codes mix their raw word, there is no size or cache to read
+template <unsigned int N>
+struct Hash<FixedBinary<N>> {
+    uint64_t operator()(const FixedBinary<N>& bin) const {
+        return mix(bin.decimal());
+    }
+};
+
+template <unsigned int N>
+struct Hash<FixedGray<N>>: public Hash<FixedBinary<N>> {};
+
+// Rotate second hash so that swapped or equal-sum pairs do not collide
+template <typename Ta, typename Tb>
+struct Hash<Couple<Ta, Tb>> {
+    uint64_t operator()(const Couple<Ta, Tb>& couple) const {
+        uint64_t first = Hash<Ta>()(couple.first());
+        uint64_t second = Hash<Tb>()(couple.second());
+        return mix(first ^ (second << 31 | second >> 33) ^ 0x9e3779b97f4a7c15ull);
+    }
+};
+
+#endif //GRAYSET_HASH_H
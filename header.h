@@ -10,10 +10,21 @@
 #define MULTISET
 #undef MULTISET
 
+// Control for caching hash value inside Binary
+#define CACHE_HASH
+#undef CACHE_HASH
+
+// Control for per operation counters and timers of Set
+#define SET_STATISTICS
+#undef SET_STATISTICS
+
 #include <iostream>
+#include <algorithm>
 #include <memory>
+#include <cstring>
 #include <string>
 #include <random>
 #include <ctime>
+#include <limits>
 
 #endif //GRAYSET_HEADER_H
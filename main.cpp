@@ -1,6 +1,303 @@
 #include "functions.h"
+#include "codec.h"
+#include "executor.h"
+#include "sampler.h"
+
+#include <chrono>
+
+// Options of non interactive run, given as command line flags
+struct Options {
+    unsigned int power = 0;
+    uint64_t carda = 0;
+    uint64_t cardb = 0;
+    uint64_t seed = 0;
+    std::string operations = "intersection,union,difference,symdiff,complement";
+    bool listed = false;
+    std::string engine = "auto";
+    unsigned int threads = 0;
+    bool table = false;
+    bool count = false;
+    bool quiet = false;
+    bool timing = false;
+};
+
+static void usage() {
+    std::cout << "Usage: GraySet [--power N] [--cardinality A[,B]] [--seed N] [--ops LIST]\n"
+              << "              [--engine auto|hash|bitset] [--threads N] [--table]\n"
+              << "              [--count-only] [--quiet] [--timing]\n"
+              << "Operations: intersection, union, difference, symdiff, complement, sum, product, all\n"
+              << "Without arguments the program asks for its input interactively." << std::endl;
+}
+
+static bool wanted(const Options& options, const char* operation) {
+    if (options.operations == "all")
+        return true;
+    const std::string list = "," + options.operations + ",";
+    return list.find(std::string(",") + operation + ",") != std::string::npos;
+}
+
+// Run phase and report its wall clock time on standard error
+template <typename Phase>
+static auto timed(const Options& options, const char* name, Phase phase) -> decltype(phase()) {
+    auto begin = std::chrono::steady_clock::now();
+    auto result = phase();
+    if (options.timing)
+        std::cerr << name << '\t'
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count()
+                  << " ms" << std::endl;
+    return result;
+}
+
+template <typename S>
+static void emit(const Options& options, const char* label, const S& set) {
+    if (options.quiet)
+        return;
+    if (options.count) {
+        Writer& out = console();
+        out << label << ": " << set.count() << '\n';
+        out.flush();
+        return;
+    }
+    show(label, set);
+}
+
+// Part number selects an independent key, so S1 and S2 of one seed differ but repeat between runs
+static uint64_t key(const Options& options, unsigned int part) {
+    return Random(options.seed, part).next();
+}
+
+// Unique set takes exactly count distinct codes, multiset draws with replacement
+static Set<Gray> sample(unsigned int power, uint64_t count, uint64_t seed, const Executor& executor) {
+    // Bound zero draws from whole range of 64 bit codes
+    const uint64_t universe = power >= 64 ? 0 : 1ull << power;
+#ifdef MULTISET
+    Set<Gray> set(16, false);
+#else
+    Set<Gray> set(16);
+#endif
+    if (!set.multiple() && power < 64)
+        count = std::min(count, universe);
+
+    // Each code is computed from its index alone, so threads fill their own part of vector
+    Vector<Gray> codes(count, Gray(power));
+    if (set.multiple()) {
+        draw(executor, seed, count, universe, [&](size_t index, uint64_t value) {
+            codes[index].decimal(encode(value));
+        });
+        set.add_range(std::move(codes));
+        return set;
+    }
+
+    const Sampler sampler(power, count, seed);
+    executor.run(count, [&](unsigned int, size_t begin, size_t end) {
+        for (size_t _ = begin; _ < end; _++)
+            codes[_].decimal(sampler[_]);
+    });
+    set.add_range(std::move(codes), Set<Gray>::DISTINCT);
+    return set;
+}
+
+static BitSet sample_bits(unsigned int power, uint64_t count, uint64_t seed) {
+    BitSet set(power);
+    for (const auto code: Sampler(power, std::min<uint64_t>(count, 1ull << power), seed))
+        set.add(code);
+    return set;
+}
+
+// Largest universe hash engine builds for complement, and largest product it materializes
+static const unsigned int HASH_UNIVERSE = 26;
+static const uint64_t PRODUCT_PAIRS = 1ull << 20;
+
+static int run_hash(const Options& options) {
+    const unsigned int power = options.power;
+
+    // Only an explicitly listed complement stops the run, default and all lists go on without it
+    bool complement = wanted(options, "complement");
+    if (complement && power > HASH_UNIVERSE) {
+        if (options.listed && options.operations != "all") {
+            std::cout << "Universe is too large for hash engine, use --engine bitset." << std::endl;
+            return 2;
+        }
+        std::cerr << "Universe is too large for hash engine, complement is skipped." << std::endl;
+        complement = false;
+    }
+
+    // Counting product needs no pairs, printing them is refused before any work when it is too big
+    const bool printed = !options.count && !options.quiet;
+    if (wanted(options, "product") && printed) {
+        const uint64_t universe = power >= 64 ? ~0ull : 1ull << power;
+        bool unique = true;
+#ifdef MULTISET
+        unique = false;
+#endif
+        const uint64_t carda = unique ? std::min(options.carda, universe) : options.carda;
+        const uint64_t cardb = unique ? std::min(options.cardb, universe) : options.cardb;
+        if (carda != 0 && cardb > PRODUCT_PAIRS / carda) {
+            std::cout << "Product is too large to print, use --count-only or leave product out." << std::endl;
+            return 2;
+        }
+    }
+
+    if (options.table)
+        table(power);
+    Set<Gray> universe = complement ? timed(options, "universe", [&]() { return universal(power); }) : Set<Gray>(1);
+
+    // Executor versions are used when threads are given
+    const Executor executor(options.threads == 0 ? 1 : options.threads);
+    const bool parallel = options.threads != 0;
+    Set<Gray> parta = timed(options, "generate S1", [&]() { return sample(power, options.carda, key(options, 1), executor); });
+    Set<Gray> partb = timed(options, "generate S2", [&]() { return sample(power, options.cardb, key(options, 2), executor); });
+    if (complement)
+        emit(options, "SU", universe);
+    emit(options, "S1", parta);
+    emit(options, "S2", partb);
+
+    if (wanted(options, "intersection"))
+        emit(options, "S1 & S2", timed(options, "intersection", [&]() {
+            return parallel ? parta.intersection(partb, executor) : parta.intersection(partb);
+        }));
+    if (wanted(options, "union"))
+        emit(options, "S1 | S2", timed(options, "union", [&]() {
+            return parallel ? parta.union_(partb, executor) : parta.union_(partb);
+        }));
+    if (wanted(options, "difference")) {
+        emit(options, "S1 - S2", timed(options, "difference", [&]() {
+            return parallel ? parta.difference(partb, executor) : parta.difference(partb);
+        }));
+        emit(options, "S2 - S1", timed(options, "difference", [&]() {
+            return parallel ? partb.difference(parta, executor) : partb.difference(parta);
+        }));
+    }
+    if (wanted(options, "symdiff"))
+        emit(options, "S1 ^ S2", timed(options, "symdiff", [&]() {
+            return parallel ? parta.symdiff(partb, executor) : parta.symdiff(partb);
+        }));
+    if (complement) {
+        emit(options, "SU \\ S1", timed(options, "complement", [&]() {
+            return parallel ? parta.complement(universe, executor) : parta.complement(universe);
+        }));
+        emit(options, "SU \\ S2", timed(options, "complement", [&]() {
+            return parallel ? partb.complement(universe, executor) : partb.complement(universe);
+        }));
+    }
+    if (wanted(options, "sum"))
+        emit(options, "S1 + S2", timed(options, "sum", [&]() { return parta.sum(partb); }));
+    if (wanted(options, "product") && !printed) {
+        const size_t pairs = timed(options, "product", [&]() { return parta.product_view(partb).count(); });
+        if (!options.quiet) {
+            Writer& out = console();
+            out << "S1 x S2: " << pairs << '\n';
+            out.flush();
+        }
+    } else if (wanted(options, "product")) {
+        emit(options, "S1 x S2", timed(options, "product", [&]() {
+            return parallel ? parta.product(partb, executor) : parta.product(partb);
+        }));
+    }
+    return 0;
+}
+
+// Bitmap engine works on whole universe words, its complement needs no universal set
+static int run_bitset(const Options& options) {
+    const unsigned int power = options.power;
+    if (options.operations != "all" && (wanted(options, "sum") || wanted(options, "product"))) {
+        std::cout << "Sum and product are not supported by bitset engine." << std::endl;
+        return 2;
+    }
+    if (options.operations == "all")
+        std::cerr << "Sum and product are not supported by bitset engine, they are skipped." << std::endl;
+
+    if (options.table)
+        table(power);
+    BitSet parta = timed(options, "generate S1", [&]() { return sample_bits(power, options.carda, key(options, 1)); });
+    BitSet partb = timed(options, "generate S2", [&]() { return sample_bits(power, options.cardb, key(options, 2)); });
+    emit(options, "S1", parta);
+    emit(options, "S2", partb);
+
+    if (wanted(options, "intersection"))
+        emit(options, "S1 & S2", timed(options, "intersection", [&]() { return parta.intersection(partb); }));
+    if (wanted(options, "union"))
+        emit(options, "S1 | S2", timed(options, "union", [&]() { return parta.union_(partb); }));
+    if (wanted(options, "difference")) {
+        emit(options, "S1 - S2", timed(options, "difference", [&]() { return parta.difference(partb); }));
+        emit(options, "S2 - S1", timed(options, "difference", [&]() { return partb.difference(parta); }));
+    }
+    if (wanted(options, "symdiff"))
+        emit(options, "S1 ^ S2", timed(options, "symdiff", [&]() { return parta.symdiff(partb); }));
+    if (wanted(options, "complement")) {
+        emit(options, "SU \\ S1", timed(options, "complement", [&]() { return parta.complement(); }));
+        emit(options, "SU \\ S2", timed(options, "complement", [&]() { return partb.complement(); }));
+    }
+    return 0;
+}
+
+static int batch(int argc, const char* argv[]) {
+    Options options;
+    options.seed = std::time(nullptr);
+    for (int index = 1; index < argc; index++) {
+        const std::string flag = argv[index];
+        if (flag == "--help") {
+            usage();
+            return 0;
+        } else if (flag == "--table") {
+            options.table = true;
+        } else if (flag == "--count-only") {
+            options.count = true;
+        } else if (flag == "--quiet") {
+            options.quiet = true;
+        } else if (flag == "--timing") {
+            options.timing = true;
+        } else if (index + 1 < argc) {
+            const char* value = argv[++index];
+            if (flag == "--power") {
+                options.power = strtoul(value, nullptr, 10);
+            } else if (flag == "--cardinality") {
+                char* rest = nullptr;
+                options.carda = strtoull(value, &rest, 10);
+                options.cardb = *rest == ',' ? strtoull(rest + 1, nullptr, 10) : options.carda;
+            } else if (flag == "--seed") {
+                options.seed = strtoull(value, nullptr, 10);
+            } else if (flag == "--ops") {
+                options.operations = value;
+                options.listed = true;
+            } else if (flag == "--engine") {
+                options.engine = value;
+            } else if (flag == "--threads") {
+                options.threads = strtoul(value, nullptr, 10);
+            } else {
+                usage();
+                return 2;
+            }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    // Bitmap pays off once universe is big, but it can not hold more than 2^32 codes
+    if (options.engine == "auto")
+        options.engine = options.power >= 16 && options.power <= BitSet::MAX_POWER ? "bitset" : "hash";
+    const unsigned int most = options.engine == "bitset" ? BitSet::MAX_POWER : GraySequence::MAX_POWER;
+    if (options.power == 0 || options.power > most || (options.engine != "hash" && options.engine != "bitset")) {
+        std::cout << "Invalid power range." << std::endl;
+        return 2;
+    }
+
+    if (options.engine == "bitset")
+        return run_bitset(options);
+    return run_hash(options);
+}
 
 int main(int argc, const char* argv[]) {
+    // Batch run reports failures such as exhausted memory instead of terminating
+    if (argc > 1) {
+        try {
+            return batch(argc, argv);
+        } catch (const std::exception& error) {
+            std::cerr << "Error: " << error.what() << std::endl;
+            return 1;
+        }
+    }
 
     input:
     unsigned int power;
@@ -41,6 +338,7 @@ int main(int argc, const char* argv[]) {
               << std::endl << std::endl;
 
     begin:
+    table(power);
     Set<Gray> universe = universal(power);
     Set<Gray> parta = random(power, carda, manual);
     Set<Gray> partb = random(power, cardb, manual);
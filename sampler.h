@@ -0,0 +1,164 @@
+#ifndef GRAYSET_SAMPLER_H
+#define GRAYSET_SAMPLER_H
+
+#include "header.h"
+#include "bits.h"
+#include "codec.h"
+#include "set.h"
+#include "executor.h"
+
+// SplitMix64 generator, streams of one seed are independent sequences
+class Random {
+private:
+    static const uint64_t GAMMA = 0x9e3779b97f4a7c15ull;
+    uint64_t _state;
+
+public:
+    explicit Random(uint64_t seed, uint64_t stream = 0): _state(mix(seed) ^ mix(stream * GAMMA + GAMMA)) {}
+
+    uint64_t next() {
+        this->_state += GAMMA;
+        return mix(this->_state);
+    }
+
+    // Uniform value below bound without modulo bias, zero bound means whole 64 bit range
+    uint64_t below(uint64_t bound) {
+        if (bound == 0)
+            return this->next();
+#if defined(__SIZEOF_INT128__)
+        // Multiply and shift, only a thin low range has to be drawn again
+        unsigned __int128 product = static_cast<unsigned __int128>(this->next()) * bound;
+        uint64_t low = static_cast<uint64_t>(product);
+        if (low < bound) {
+            const uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<unsigned __int128>(this->next()) * bound;
+                low = static_cast<uint64_t>(product);
+            }
+        }
+        return static_cast<uint64_t>(product >> 64);
+#else
+        const uint64_t threshold = (0 - bound) % bound;
+        uint64_t value = this->next();
+        while (value < threshold)
+            value = this->next();
+        return value % bound;
+#endif
+    }
+};
+
+// Exactly uniform count distinct values of [0, 2^power) in O(count), one lookup per draw
+template <typename Emit>
+void floyd(unsigned int power, uint64_t count, Random& random, Emit emit) {
+    const uint64_t last = power >= 64 ? ~0ull : (1ull << power) - 1;
+    if (power < 64 && count > last + 1)
+        throw std::range_error("Sample is larger than universe.");
+
+    Set<uint64_t> chosen(1);
+    chosen.reserve(count);
+    for (uint64_t step = 0; step < count; step++) {
+        const uint64_t top = last - (count - 1 - step);
+        uint64_t value = random.below(top + 1);
+        if (chosen.in(value))
+            value = top;
+        chosen.add(value);
+        emit(value);
+    }
+}
+
+// Keyed bijection of [0, 2^power) from a balanced Feistel network, odd powers walk the cycle back into range
+class Permutation {
+private:
+    static const unsigned int ROUNDS = 4;
+
+    unsigned int _power;
+    unsigned int _half;
+    uint64_t _mask;
+    uint64_t _keys[ROUNDS];
+
+    uint64_t _round(uint64_t value) const {
+        uint64_t left = value >> this->_half;
+        uint64_t right = value & this->_mask;
+        for (const auto key: this->_keys) {
+            const uint64_t next = left ^ (mix(right ^ key) & this->_mask);
+            left = right;
+            right = next;
+        }
+        return (left << this->_half) | right;
+    }
+
+public:
+    Permutation() = delete;
+    explicit Permutation(unsigned int power, uint64_t seed): _power(power), _half((power + 1) / 2) {
+        if (power == 0 || power > 64)
+            throw std::range_error("Power of permutation must between 1 and 64.");
+        this->_mask = (1ull << this->_half) - 1;
+        Random random(seed);
+        for (auto& key: this->_keys)
+            key = random.next();
+    }
+
+    unsigned int power() const { return this->_power; }
+
+    uint64_t operator()(uint64_t index) const {
+        uint64_t value = this->_round(index);
+        while (this->_power < 2 * this->_half && value >> this->_power)
+            value = this->_round(value);
+        return value;
+    }
+};
+
+// Stream of count distinct Gray codes in pseudo random order, every element is computed on its own
+class Sampler {
+private:
+    Permutation _permutation;
+    uint64_t _count;
+
+public:
+    Sampler() = delete;
+    explicit Sampler(unsigned int power, uint64_t count, uint64_t seed): _permutation(power, seed), _count(count) {
+        if (power < 64 && count > (1ull << power))
+            throw std::range_error("Sample is larger than universe.");
+    }
+
+    uint64_t count() const { return this->_count; }
+    unsigned int power() const { return this->_permutation.power(); }
+
+    uint64_t operator[](uint64_t index) const {
+        return encode(this->_permutation(index));
+    }
+
+    class Iterator {
+    private:
+        const Sampler* _sampler;
+        uint64_t _index;
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(const Sampler* sampler, uint64_t index): _sampler(sampler), _index(index) {};
+        uint64_t operator*() const { return (*this->_sampler)[this->_index]; }
+        Iterator& operator++() {
+            this->_index++;
+            return *this;
+        }
+        bool operator!=(const Iterator& iter) const {
+            return this->_index != iter._index;
+        }
+    };
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, this->_count); }
+};
+
+// Draw count values below bound on executor threads, each index owns a stream so thread count does not change result
+template <typename Emit>
+void draw(const Executor& executor, uint64_t seed, uint64_t count, uint64_t bound, Emit emit) {
+    executor.run(count, [&](unsigned int, size_t begin, size_t end) {
+        for (size_t _ = begin; _ < end; _++) {
+            Random random(seed, _);
+            emit(_, random.below(bound));
+        }
+    });
+}
+
+#endif //GRAYSET_SAMPLER_H
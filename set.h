@@ -4,125 +4,622 @@
 #include "header.h"
 #include "vector.h"
 #include "couple.h"
+#include "hash.h"
+#include "executor.h"
+#include "bits.h"
+#include "stats.h"
 
-template <typename T>
-unsigned int hash(size_t, const T&);
+template <typename T, typename H>
+class ZipView;
 
-template <typename T>
+template <typename T, typename H>
+class ProductView;
+
+template <typename T, typename H>
+class ConcurrentSet;
+
+template <typename T, typename H = Hash<T>>
 class Set {
+    template <typename U, typename G>
+    friend class Set;
+    friend class ZipView<T, H>;
+    friend class ProductView<T, H>;
+    friend class ConcurrentSet<T, H>;
+
+public:
+    // What caller knows about input of bulk build, lets build skip lookups
+    enum Input {
+        ARBITRARY,  // Any order, duplicates allowed
+        SORTED,     // Equal values are adjacent
+        DISTINCT    // Values differ from each other and from set content
+    };
+
 private:
+    // Index slot pointing into dense storage, distance is probe length plus one and zero means empty
+    struct Slot {
+        uint32_t distance;
+        uint32_t fingerprint;
+        size_t position;
+    };
+
     size_t _size;
-    Vector<T>** _slots;
+    Vector<Slot> _slots;
+    Vector<T> _elements;
+    Vector<uint64_t> _hashes;
+    H _hasher;
     bool _unique;
-    Vector<Couple<size_t, size_t>>* _registry;
+    float _load;
+
+    // Multiset keeps each element once with its count, mode is position of largest count
+    Vector<unsigned int> _counts;
+    size_t _total;
+    mutable size_t _mode;
+    mutable bool _stale;
+#ifdef SET_STATISTICS
+    mutable SetCounters _counters;
+#endif
+
+    // Round number of slots up to power of two so probing can wrap with mask
+    static size_t _round(size_t slots) {
+        size_t size = 1;
+        while (size < slots)
+            size <<= 1;
+        return size;
+    }
+
+    // Low bits of hash choose home slot, high bits are kept to skip most comparisons
+    static uint32_t _fingerprint(uint64_t hash) {
+        return static_cast<uint32_t>(hash >> 32);
+    }
+
+    // Find slot index of value with known hash, or _size when not found
+    size_t _locate(const T& value, uint64_t hash) const {
+        const size_t mask = this->_size - 1;
+        const uint32_t fingerprint = _fingerprint(hash);
+        size_t index = hash & mask;
+        for (uint32_t distance = 1; ; distance++) {
+            const Slot& slot = this->_slots[index];
+
+            // Robin Hood invariant: a richer slot means value cannot be further
+            if (slot.distance < distance)
+                return this->_size;
+            if (slot.fingerprint == fingerprint && this->_elements[slot.position] == value)
+                return index;
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Find slot index referring to given dense position
+    size_t _slot_of(size_t position) const {
+        const size_t mask = this->_size - 1;
+        size_t index = this->_hashes[position] & mask;
+        while (this->_slots[index].position != position || this->_slots[index].distance == 0)
+            index = (index + 1) & mask;
+        return index;
+    }
+
+    // Index element at dense position, index must have a free slot
+    void _place(size_t position) {
+        const size_t mask = this->_size - 1;
+        const uint64_t hash = this->_hashes[position];
+        size_t index = hash & mask;
+        Slot carried = {1, _fingerprint(hash), position};
+        while (true) {
+            Slot& slot = this->_slots[index];
+            if (slot.distance == 0) {
+                slot = carried;
+                return;
+            }
+
+            // Steal slot from element closer to its home and carry it forward
+            if (slot.distance < carried.distance)
+                std::swap(slot, carried);
+            index = (index + 1) & mask;
+            carried.distance++;
+        }
+    }
+
+    // Remove index slot by shifting following slots backward, no tombstones left
+    void _erase(size_t index) {
+        const size_t mask = this->_size - 1;
+        size_t next = (index + 1) & mask;
+        while (this->_slots[next].distance > 1) {
+            this->_slots[index] = this->_slots[next];
+            this->_slots[index].distance--;
+            index = next;
+            next = (next + 1) & mask;
+        }
+        this->_slots[index].distance = 0;
+    }
+
+    // Hashes are cached per element, so rehashing never calls the hasher
+    void _rehash(size_t slots) {
+        SET_TIMER(resize);
+        this->_size = _round(slots);
+        this->_slots = Vector<Slot>(this->_size, Slot{0, 0, 0}, this->_slots.arena());
+        for (size_t position = 0; position < this->_elements.count(); position++)
+            this->_place(position);
+    }
+
+    bool _contains(const T& value, uint64_t hash) const {
+        if (this->_elements.empty()) return false;
+        return this->_locate(value, hash) != this->_size;
+    }
+
+    // Count of element at dense position, always one in unique set
+    unsigned int _count(size_t position) const {
+        return this->_unique ? 1 : this->_counts[position];
+    }
+
+    // Count of value with known hash, zero when not found
+    unsigned int _multiplicity(const T& value, uint64_t hash) const {
+        if (this->_elements.empty())
+            return 0;
+        size_t index = this->_locate(value, hash);
+        if (index == this->_size)
+            return 0;
+        return this->_count(this->_slots[index].position);
+    }
+
+    // Raise mode when count at position passes it, ties keep the older mode
+    void _promote(size_t position) const {
+        if (!this->_stale && this->_counts[position] > this->_counts[this->_mode])
+            this->_mode = position;
+    }
+
+    // Append without duplicate check, caller makes sure value is not in set yet
+    template <typename V>
+    void _append(V&& value, uint64_t hash, unsigned int count = 1) {
+        if (this->_elements.count() + 1 >= this->_size * this->_load)
+            this->_rehash(std::max<size_t>(this->_size * 2, 2));
+        this->_elements.append(std::forward<V>(value));
+        this->_hashes.append(hash);
+        this->_place(this->_elements.count() - 1);
+        if (this->_unique)
+            return;
+
+        this->_counts.append(count);
+        this->_total += count;
+        if (this->_elements.count() == 1)
+            this->_mode = 0;
+        this->_promote(this->_elements.count() - 1);
+    }
+
+    // Add count copies of value, unique set keeps one and multiset raises count
+    void _insert(const T& value, uint64_t hash, unsigned int count) {
+        if (count == 0)
+            return;
+        if (this->_elements.empty()) {
+            this->_append(value, hash, count);
+            return;
+        }
+
+        size_t index = this->_locate(value, hash);
+        if (index == this->_size) {
+            this->_append(value, hash, count);
+            return;
+        }
+        if (this->_unique)
+            return;
+
+        size_t position = this->_slots[index].position;
+        this->_counts[position] += count;
+        this->_total += count;
+        this->_promote(position);
+    }
+
+    void _add(const T& value, uint64_t hash) {
+        this->_insert(value, hash, 1);
+    }
+
+    // Rebuild index over current dense storage reusing slot array
+    void _reindex() {
+        for (size_t _ = 0; _ < this->_size; _++)
+            this->_slots[_].distance = 0;
+        for (size_t position = 0; position < this->_elements.count(); position++)
+            this->_place(position);
+    }
+
+    // Set new count of every element from measure, zero drops element and order is kept
+    template <typename Measure>
+    void _retain(Measure measure) {
+        size_t write = 0;
+        this->_total = 0;
+        for (size_t read = 0; read < this->_elements.count(); read++) {
+            unsigned int count = measure(this->_elements[read], this->_hashes[read], this->_count(read));
+            if (count == 0)
+                continue;
+            if (write != read) {
+                this->_elements[write].~T();
+                new (&this->_elements[write]) T(std::move(this->_elements[read]));
+                this->_hashes[write] = this->_hashes[read];
+            }
+            if (!this->_unique) {
+                this->_counts[write] = count;
+                this->_total += count;
+            }
+            write++;
+        }
+        this->_stale = true;
+        if (write == this->_elements.count())
+            return;
+        this->_elements.truncate(write);
+        this->_hashes.truncate(write);
+        this->_counts.truncate(write);
+        this->_reindex();
+    }
+
+    // Index elements appended after start in one pass, duplicates are merged and tail compacted
+    void _build(size_t start, Input input) {
+        const size_t total = this->_elements.count();
+        for (size_t position = start; position < total; position++)
+            this->_hashes.append(this->_hasher(this->_elements[position]));
+
+        // Grow index once for whole batch, old elements are placed again
+        if (total + 1 >= this->_size * this->_load) {
+            SET_TIMER(resize);
+            this->_size = _round(static_cast<size_t>(total / this->_load) + 1);
+            this->_slots = Vector<Slot>(this->_size, Slot{0, 0, 0}, this->_slots.arena());
+            for (size_t position = 0; position < start; position++)
+                this->_place(position);
+        }
+
+        static const size_t AHEAD = 8;
+        const size_t mask = this->_size - 1;
+        size_t write = start;
+        for (size_t read = start; read < total; read++) {
+            if (read + AHEAD < total)
+                prefetch(&this->_slots[this->_hashes[read + AHEAD] & mask]);
+            const uint64_t hash = this->_hashes[read];
+
+            // Find earlier copy, sorted input only has to look at last kept value
+            size_t found = this->_size;
+            if (input == SORTED && write > start && this->_elements[write - 1] == this->_elements[read])
+                found = this->_slot_of(write - 1);
+            else if (input == ARBITRARY || (input == SORTED && start != 0))
+                found = write == 0 ? this->_size : this->_locate(this->_elements[read], hash);
+            if (found != this->_size) {
+                if (!this->_unique) {
+                    this->_counts[this->_slots[found].position]++;
+                    this->_total++;
+                }
+                continue;
+            }
+
+            if (write != read) {
+                this->_elements[write].~T();
+                new (&this->_elements[write]) T(std::move(this->_elements[read]));
+                this->_hashes[write] = hash;
+            }
+            this->_place(write);
+            if (!this->_unique) {
+                this->_counts.append(1);
+                this->_total++;
+            }
+            write++;
+        }
+
+        this->_elements.truncate(write);
+        this->_hashes.truncate(write);
+        this->_stale = true;
+    }
+
+    // Measure source on all threads into per shard position lists, then merge shards in order
+    template <typename Measure>
+    void _gather(const Set<T, H>& source, const Executor& executor, Measure measure) {
+        typedef Couple<size_t, unsigned int> Entry;
+        const size_t distinct = source._elements.count();
+        Vector<Vector<Entry>> shards(executor.shards(distinct), Vector<Entry>());
+        executor.run(distinct, [&](unsigned int shard, size_t begin, size_t end) {
+            Vector<Entry>& entries = shards[shard];
+            for (size_t _ = begin; _ < end; _++) {
+                unsigned int count = measure(source._elements[_], source._hashes[_], source._count(_));
+                if (count != 0)
+                    entries.emplace(_, count);
+            }
+        });
+
+        size_t total = 0;
+        for (const auto& entries: shards)
+            total += entries.count();
+        this->reserve(this->_elements.count() + total);
+
+        // Source elements are distinct, so only a non empty receiver needs lookups
+        const bool check = !this->_elements.empty();
+        for (const auto& entries: shards)
+            for (const auto& entry: entries) {
+                const size_t position = entry.first();
+                if (check)
+                    this->_insert(source._elements[position], source._hashes[position], entry.second());
+                else
+                    this->_append(source._elements[position], source._hashes[position], entry.second());
+            }
+    }
 
 public:
     Set() = delete;
-    explicit Set(size_t slots, bool unique = true):
-    _size(slots), _unique(unique), _registry(nullptr) {
+    // All storage of set comes from arena when given, arena must outlive the set
+    explicit Set(size_t slots, bool unique = true, float load = 0.875f, Arena* arena = nullptr):
+    _size(0), _slots(arena), _elements(arena), _hashes(arena), _unique(unique), _load(load),
+    _counts(arena), _total(0), _mode(0), _stale(false) {
 
         // Detect when number of slots is equal to 0
         if (slots <= 0)
             throw std::range_error("Number of slots must greater than 0.");
+        if (load <= 0 || load >= 1)
+            throw std::range_error("Load factor must between 0 and 1.");
 
-        this->_slots = new Vector<T>*[slots];
-        for (size_t _ = 0; _ < slots; _++)
-            this->_slots[_] = new Vector<T>;
-
-        this->_registry = new Vector<Couple<size_t, size_t>>;
+        this->_size = _round(slots);
+        this->_slots.resize(this->_size, Slot{0, 0, 0});
     }
 
+    // Number of elements, multiset counts every copy
     inline size_t count() const {
-        return this->_registry->count();
+        return this->_unique ? this->_elements.count() : this->_total;
     }
 
-    void add(const T& value) {
-        const unsigned int key = hash(this->_size, value);
-        Vector<T>* slot = this->_slots[key];
+    // Number of different elements
+    inline size_t distinct() const {
+        return this->_elements.count();
+    }
+
+    inline size_t capacity() const {
+        return this->_size;
+    }
 
-        // Use the short-circuit theorem to check whether the same value exists
-        if (this->_unique && slot->exist(value))
+    Arena* arena() const {
+        return this->_elements.arena();
+    }
+
+    Set(const Set<T, H>& set) = default;
+    Set<T, H>& operator=(const Set<T, H>& set) = default;
+
+    // Moved from set stays valid and empty, first add allocates a new index
+    Set(Set<T, H>&& set) noexcept:
+    _size(set._size), _slots(std::move(set._slots)), _elements(std::move(set._elements)),
+    _hashes(std::move(set._hashes)), _hasher(std::move(set._hasher)),
+    _unique(set._unique), _load(set._load), _counts(std::move(set._counts)),
+    _total(set._total), _mode(set._mode), _stale(set._stale) {
+#ifdef SET_STATISTICS
+        this->_counters = set._counters;
+#endif
+        set._size = 0;
+        set._total = 0;
+    }
+
+    Set<T, H>& operator=(Set<T, H>&& set) noexcept {
+        if (this == &set)
+            return *this;
+        this->_size = set._size;
+        this->_slots = std::move(set._slots);
+        this->_elements = std::move(set._elements);
+        this->_hashes = std::move(set._hashes);
+        this->_hasher = std::move(set._hasher);
+        this->_unique = set._unique;
+        this->_load = set._load;
+        this->_counts = std::move(set._counts);
+        this->_total = set._total;
+        this->_mode = set._mode;
+        this->_stale = set._stale;
+#ifdef SET_STATISTICS
+        this->_counters = set._counters;
+#endif
+        set._size = 0;
+        set._total = 0;
+        return *this;
+    }
+
+    float max_load_factor() const {
+        return this->_load;
+    }
+
+    void max_load_factor(float load) {
+        if (load <= 0 || load >= 1)
+            throw std::range_error("Load factor must between 0 and 1.");
+        this->_load = load;
+        this->reserve(this->_elements.count());
+    }
+
+    // Grow storage and index so that given number of different elements fits without rehashing
+    void reserve(size_t count) {
+        this->_elements.reserve(count);
+        this->_hashes.reserve(count);
+        if (!this->_unique)
+            this->_counts.reserve(count);
+        if (count < this->_size * this->_load)
             return;
+        this->_rehash(static_cast<size_t>(count / this->_load) + 1);
+    }
 
-        // Add to registry
-        this->_registry->append(Couple<size_t, size_t>(key, slot->count()));
-        slot->append(value);
+    void add(const T& value) {
+        SET_TIMER(add);
+        this->_add(value, this->_hasher(value));
     }
 
+    // Copy range into storage first, then hash and index it as one batch
+    template <typename Iter>
+    void add_range(Iter begin, Iter end, Input input = ARBITRARY) {
+        SET_TIMER(build);
+        const size_t start = this->_elements.count();
+        for (; begin != end; ++begin)
+            this->_elements.append(*begin);
+        this->_build(start, input);
+    }
+
+    // Empty set takes storage of elements over when both use same arena
+    void add_range(Vector<T>&& elements, Input input = ARBITRARY) {
+        SET_TIMER(build);
+        const size_t start = this->_elements.count();
+        if (start == 0 && elements.arena() == this->_elements.arena()) {
+            this->_elements = std::move(elements);
+        } else {
+            this->_elements.reserve(start + elements.count());
+            for (auto& value: elements)
+                this->_elements.append(std::move(value));
+        }
+        this->_hashes.reserve(this->_elements.count());
+        if (!this->_unique)
+            this->_counts.reserve(this->_elements.count());
+        this->_build(start, input);
+    }
+
+    template <typename Iter>
+    static Set<T, H> from_range(Iter begin, Iter end, bool unique = true, Input input = ARBITRARY) {
+        Set<T, H> result(1, unique);
+        result.add_range(begin, end, input);
+        return result;
+    }
+
+    // Swap last element into the hole so removal costs O(1), multiset removes one copy
     void remove(const T& value) {
-        const unsigned int key = hash(this->_size, value);
-        Vector<T>* slot = this->_slots[key];
+        SET_TIMER(remove);
+        if (this->_elements.empty())
+            return;
+        size_t index = this->_locate(value, this->_hasher(value));
+        if (index == this->_size)
+            return;
 
-        // Remove from registry
-        slot->remove(value);
-        this->_registry->remove(Couple<size_t, size_t>(key, slot->count()));
+        size_t position = this->_slots[index].position;
+        if (!this->_unique) {
+            this->_total--;
+            if (position == this->_mode)
+                this->_stale = true;
+            if (--this->_counts[position] != 0)
+                return;
+        }
+
+        size_t last = this->_elements.count() - 1;
+        this->_erase(index);
+        if (position != last)
+            this->_slots[this->_slot_of(last)].position = position;
+        this->_elements.swap_pop(position);
+        this->_hashes.swap_pop(position);
+        if (this->_unique)
+            return;
+        this->_counts.swap_pop(position);
+        if (this->_mode == last)
+            this->_mode = position;
     }
 
     bool in(const T& value) const {
-        const unsigned int key = hash(this->_size, value);
-        Vector<T>* slot = this->_slots[key];
-        if (slot->empty()) return false;
-
-        // Check if in slot
-        if (slot->exist(value))
-            return true;
-        return false;
+        SET_TIMER(in);
+        return this->_contains(value, this->_hasher(value));
     }
 
     bool multiple() const {
         return not this->_unique;
     }
 
-    ~Set() {
-        for (size_t _ = 0; _ < this->_size; _++)
-            delete this->_slots[_];
-        delete[] this->_slots;
-        if (this->_registry != nullptr)
-            delete this->_registry;
+    // Element at position in iteration order, multiset has to walk counts
+    const T& index(size_t position) const {
+        if (this->_unique)
+            return this->_elements.get(position);
+        for (size_t _ = 0; _ < this->_elements.count(); _++) {
+            if (position < this->_counts[_])
+                return this->_elements[_];
+            position -= this->_counts[_];
+        }
+        throw std::out_of_range("Invalid index value.");
     }
 
 public:
+    // Multiset elements are repeated by their counts, count pointer is null in unique set
     class Iterator {
     private:
-        size_t _index;
-        Vector<T>** _slots;
-        Vector<Couple<size_t, size_t>>* _registry;
+        const T* _element;
+        const unsigned int* _count;
+        unsigned int _repeat;
 
     public:
         Iterator() = delete;
-        explicit Iterator(Vector<T>** slots, Vector<Couple<size_t, size_t>>* registry, size_t index = 0):
-            _registry(registry), _slots(slots), _index(index) {};
+        explicit Iterator(const T* element, const unsigned int* count):
+            _element(element), _count(count), _repeat(0) {};
         const T& operator*() const {
-            const Couple<size_t, size_t> position = this->_registry->index(this->_index);
-            size_t slot = position.first();
-            size_t index = position.second();
-            return this->_slots[slot]->index(index);
+            return *this->_element;
         }
         Iterator operator++() {
-            this->_index++;
+            if (this->_count != nullptr) {
+                if (++this->_repeat < *this->_count)
+                    return *this;
+                this->_repeat = 0;
+                this->_count++;
+            }
+            this->_element++;
             return *this;
         }
-        bool operator!=(const Set<T>::Iterator& iter) {
-            return this->_index != iter._index;
+        bool operator!=(const Iterator& iter) const {
+            return this->_element != iter._element || this->_repeat != iter._repeat;
         }
 
     };
 
 public:
-    Iterator begin() const { return Iterator(this->_slots, this->_registry); }
-    Iterator end() const { return Iterator(this->_slots, this->_registry,
-                                           this->_registry->count()); }
+    Iterator begin() const {
+        return Iterator(this->_elements.begin(), this->_unique ? nullptr : this->_counts.begin());
+    }
+    Iterator end() const {
+        return Iterator(this->_elements.end(), this->_unique ? nullptr : this->_counts.end());
+    }
+
+    // Shape of table is measured on call, operation counters need SET_STATISTICS
+    SetStats stats() const {
+        SetStats result;
+        result.count = this->count();
+        result.distinct = this->distinct();
+        result.slots = this->_size;
+        result.max_load = this->_load;
+        result.load = this->_size == 0 ? 0 : static_cast<double>(this->distinct()) / this->_size;
+
+        size_t total = 0;
+        for (size_t _ = 0; _ < this->_size; _++) {
+            const uint32_t distance = this->_slots[_].distance;
+            if (distance == 0)
+                continue;
+            if (result.probes.count() < distance)
+                result.probes.resize(distance, 0);
+            result.probes[distance - 1]++;
+            result.longest = std::max<size_t>(result.longest, distance);
+            result.displaced += distance > 1;
+            total += distance;
+        }
+        result.average = this->distinct() == 0 ? 0 : static_cast<double>(total) / this->distinct();
+
+        Vector<uint64_t> hashes(this->_hashes);
+        std::sort(hashes.begin(), hashes.end());
+        for (size_t _ = 1; _ < hashes.count(); _++)
+            result.collisions += hashes[_] == hashes[_ - 1];
+
+        result.element_bytes = this->_elements.capacity() * sizeof(T);
+        result.overhead_bytes = sizeof(*this) + this->_slots.capacity() * sizeof(Slot) +
+            this->_hashes.capacity() * sizeof(uint64_t) + this->_counts.capacity() * sizeof(unsigned int);
+
+#ifdef SET_STATISTICS
+        const SetCounters& counters = this->_counters;
+        result.counted = true;
+        result.resizes = counters.resize.calls;
+        const std::pair<const char*, const Counter*> operations[] = {
+            {"add", &counters.add}, {"in", &counters.in}, {"remove", &counters.remove},
+            {"build", &counters.build}, {"intersection", &counters.intersection},
+            {"union", &counters.union_}, {"difference", &counters.difference},
+            {"symdiff", &counters.symdiff}, {"complement", &counters.complement},
+            {"product", &counters.product}, {"resize", &counters.resize}
+        };
+        for (const auto& operation: operations)
+            result.operations.append(SetStats::Operation{
+                operation.first, operation.second->calls.load(), operation.second->nanoseconds.load()});
+#endif
+        return result;
+    }
 
 #ifdef DEBUG
 public:
     void _debug_vectors() const {
-        std::cout << "Set count: " << this->count() << std::endl;
-        std::cout << "Vectors begin:" << this->_slots << std::endl;
-        for (auto index = 0; index < this->_size; index++) {
-            Vector<T>* ptr = this->_slots[index];
-            std::cout << index + 1 << ". " << this->_slots + index
-                      << '\t' << this->_slots[index] << '\t' << "Count: "
-                      << ptr->count() << std::endl;
+        std::cout << "Set count: " << this->count() << " distinct: " << this->distinct() << std::endl;
+        std::cout << "Slots begin:" << this->_slots.data() << std::endl;
+        for (size_t index = 0; index < this->_size; index++) {
+            std::cout << index + 1 << ". " << this->_slots.data() + index
+                      << '\t' << "Distance: " << this->_slots[index].distance
+                      << '\t' << "Position: " << this->_slots[index].position << std::endl;
         }
         std::cout << "----------" << std::endl;
     }
@@ -130,112 +627,418 @@ public:
 
 public:
 
-    // All arithmetic operations
-    Set<T> intersection(const Set<T>& other) const {
-        size_t size = std::max(this->_size, other._size);
-        Set<T> result(size, this->_unique);
-        for (auto&& value: other)
-            if (this->in(value))
-                result.add(value);
+    // All arithmetic operations, multisets take min, max and clipped difference of counts
+    Set<T, H> intersection(const Set<T, H>& other) const {
+        SET_TIMER(intersection);
+        size_t size = std::max<size_t>({this->_size, other._size, 1});
+        Set<T, H> result(size, this->_unique);
+
+        // Probe larger table with smaller operand, counts are symmetric under min
+        const Set<T, H>& probe = (other.distinct() > this->distinct()) ? *this : other;
+        const Set<T, H>& table = (&probe == this) ? other : *this;
+        for (size_t _ = 0; _ < probe.distinct(); _++) {
+            unsigned int count = table._multiplicity(probe._elements[_], probe._hashes[_]);
+            if (count != 0)
+                result._append(probe._elements[_], probe._hashes[_], std::min(count, probe._count(_)));
+        }
 
         return result;
     }
 
-    Set<T> union_(const Set<T>& other) const {
-        Set<T> result(this->_size + other._size, this->_unique);
-        for (auto&& value: *this)
-            result.add(value);
-        for (auto&& value: other)
-            result.add(value);
+    Set<T, H> union_(const Set<T, H>& other) const {
+        SET_TIMER(union_);
+        Set<T, H> result(std::max<size_t>(this->_size + other._size, 1), this->_unique);
+        for (size_t _ = 0; _ < this->distinct(); _++)
+            result._append(this->_elements[_], this->_hashes[_], this->_count(_));
+        for (size_t _ = 0; _ < other.distinct(); _++) {
+            unsigned int count = this->_multiplicity(other._elements[_], other._hashes[_]);
+            if (other._count(_) > count)
+                result._insert(other._elements[_], other._hashes[_], other._count(_) - count);
+        }
 
         return result;
     }
 
-    Set<T> difference(const Set<T>& other) const {
-        size_t size = std::max(this->_size, other._size);
-        Set<T> result(size, this->_unique);
-        for (const auto& value: *this)
-            if (!other.in(value))
-                result.add(value);
+    Set<T, H> difference(const Set<T, H>& other) const {
+        SET_TIMER(difference);
+        size_t size = std::max<size_t>({this->_size, other._size, 1});
+        Set<T, H> result(size, this->_unique, this->_load);
+        for (size_t _ = 0; _ < this->distinct(); _++) {
+            unsigned int count = other._multiplicity(this->_elements[_], this->_hashes[_]);
+            if (this->_count(_) > count)
+                result._append(this->_elements[_], this->_hashes[_], this->_count(_) - count);
+        }
+
+        return result;
+    }
 
+    // Additive union, multiset counts are summed and unique set behaves as union
+    Set<T, H> merge(const Set<T, H>& other) const {
+        Set<T, H> result(*this);
+        result.merge_with(other);
         return result;
     }
 
-    Set<T> symdiff(const Set<T>& other) const {
-        Set<T> parta = this->difference(other);
-        Set<T> partb = other.difference(*this);
-        return parta.union_(partb);
+    Set<T, H> symdiff(const Set<T, H>& other) const {
+        Set<T, H> result(*this);
+        result.symdiff_with(other);
+        return result;
     }
 
-    Set<T> complement(const Set<T>& universal) const {
-        Set<T> result(universal._size, this->_unique);
-        for (const auto& value: universal)
-            if (!this->in(value))
-                result.add(value);
+    Set<T, H> complement(const Set<T, H>& universal) const {
+        SET_TIMER(complement);
+        Set<T, H> result(std::max<size_t>(universal._size, 1), this->_unique);
+        for (size_t _ = 0; _ < universal.distinct(); _++) {
+            unsigned int count = this->_multiplicity(universal._elements[_], universal._hashes[_]);
+            if (universal._count(_) > count)
+                result._append(universal._elements[_], universal._hashes[_], universal._count(_) - count);
+        }
 
         return result;
     }
 
-    Set<Couple<T, T>> sum(const Set<T>& other) const {
-        size_t size = std::min(this->_size, other._size);
-        Set<Couple<T, T>> result(size, this->_unique);
+public:
 
-        // No requirement for end iter cuz size has been defined
-        Set<T>::Iterator this_iter = this->begin();
-        Set<T>::Iterator other_iter = other.begin();
-        Set<T>::Iterator this_stop = this->end();
-        Set<T>::Iterator other_stop = other.end();
+    // In place operations, receiver is changed without building a new table
+    Set<T, H>& intersect_with(const Set<T, H>& other) {
+        SET_TIMER(intersection);
+        if (&other == this)
+            return *this;
+        this->_retain([&other](const T& value, uint64_t hash, unsigned int count) {
+            return std::min(count, other._multiplicity(value, hash));
+        });
+        return *this;
+    }
 
-        // Fix Empty set bug
-        while (this_iter != this_stop && other_iter != other_stop) {
-            const T& value_a(*this_iter);
-            const T& value_b(*other_iter);
-            Couple<T, T> couple(value_a, value_b);
-            result.add(couple);
+    Set<T, H>& unite_with(const Set<T, H>& other) {
+        SET_TIMER(union_);
+        if (&other == this)
+            return *this;
+        this->reserve(this->distinct() + other.distinct());
+        for (size_t _ = 0; _ < other.distinct(); _++) {
+            unsigned int count = this->_multiplicity(other._elements[_], other._hashes[_]);
+            if (other._count(_) > count)
+                this->_insert(other._elements[_], other._hashes[_], other._count(_) - count);
+        }
+        return *this;
+    }
 
-            // Increment for iterators
-            ++this_iter; ++other_iter;
+    // Existing elements only change counts, so merging set into itself is safe
+    Set<T, H>& merge_with(const Set<T, H>& other) {
+        SET_TIMER(union_);
+        this->reserve(this->distinct() + other.distinct());
+        const size_t distinct = other.distinct();
+        for (size_t _ = 0; _ < distinct; _++)
+            this->_insert(other._elements[_], other._hashes[_], other._count(_));
+        return *this;
+    }
+
+    Set<T, H>& subtract(const Set<T, H>& other) {
+        SET_TIMER(difference);
+        if (&other == this) {
+            this->_elements.clear();
+            this->_hashes.clear();
+            this->_counts.clear();
+            this->_total = 0;
+            this->_reindex();
+            return *this;
         }
+        this->_retain([&other](const T& value, uint64_t hash, unsigned int count) {
+            unsigned int taken = other._multiplicity(value, hash);
+            return count > taken ? count - taken : 0;
+        });
+        return *this;
+    }
 
+    Set<T, H>& symdiff_with(const Set<T, H>& other) {
+        if (&other == this)
+            return this->subtract(other);
+        SET_TIMER(symdiff);
+
+        // Find additions before receiver changes, then keep count differences of common elements
+        // Scratch positions come from arena of receiver when it has one
+        Vector<size_t> additions(this->arena());
+        for (size_t _ = 0; _ < other.distinct(); _++)
+            if (!this->_contains(other._elements[_], other._hashes[_]))
+                additions.append(_);
+        this->_retain([&other](const T& value, uint64_t hash, unsigned int count) {
+            unsigned int taken = other._multiplicity(value, hash);
+            return count > taken ? count - taken : taken - count;
+        });
+
+        this->reserve(this->distinct() + additions.count());
+        for (const auto position: additions)
+            this->_append(other._elements[position], other._hashes[position], other._count(position));
+        return *this;
+    }
+
+    Set<T, H>& operator&=(const Set<T, H>& other) { return this->intersect_with(other); }
+    Set<T, H>& operator|=(const Set<T, H>& other) { return this->unite_with(other); }
+    Set<T, H>& operator+=(const Set<T, H>& other) { return this->merge_with(other); }
+    Set<T, H>& operator-=(const Set<T, H>& other) { return this->subtract(other); }
+    Set<T, H>& operator^=(const Set<T, H>& other) { return this->symdiff_with(other); }
+
+    // Lazy pairs by position, nothing is allocated until materialized
+    ZipView<T, H> zip_view(const Set<T, H>& other) const {
+        return ZipView<T, H>(*this, other);
+    }
+
+    ProductView<T, H> product_view(const Set<T, H>& other) const {
+        return ProductView<T, H>(*this, other);
+    }
+
+    Set<Couple<T, T>> sum(const Set<T, H>& other) const {
+        return this->zip_view(other).materialize();
+    }
+
+    Set<Couple<T, T>> product(const Set<T, H>& other) const {
+        SET_TIMER(product);
+        return this->product_view(other).materialize();
+    }
+
+public:
+
+    // Parallel arithmetic operations, filtering runs on executor threads without locks
+    Set<T, H> intersection(const Set<T, H>& other, const Executor& executor) const {
+        SET_TIMER(intersection);
+        const Set<T, H>& probe = (other.distinct() > this->distinct()) ? *this : other;
+        const Set<T, H>& table = (&probe == this) ? other : *this;
+        Set<T, H> result(1, this->_unique);
+        result._gather(probe, executor, [&table](const T& value, uint64_t hash, unsigned int count) {
+            return std::min(count, table._multiplicity(value, hash));
+        });
         return result;
     }
 
-    Set<Couple<T, T>> product(const Set<T>& other) const {
-        size_t size = this->_size * other._size;
-        Set<Couple<T, T>> result(size, this->_unique);
+    // Result starts as copy of receiver, so only the part of other above it is gathered
+    Set<T, H> union_(const Set<T, H>& other, const Executor& executor) const {
+        SET_TIMER(union_);
+        Set<T, H> result(*this);
+        result._gather(other, executor, [this](const T& value, uint64_t hash, unsigned int count) {
+            unsigned int taken = this->_multiplicity(value, hash);
+            return count > taken ? count - taken : 0;
+        });
+        return result;
+    }
+
+    Set<T, H> difference(const Set<T, H>& other, const Executor& executor) const {
+        SET_TIMER(difference);
+        Set<T, H> result(1, this->_unique);
+        result._gather(*this, executor, [&other](const T& value, uint64_t hash, unsigned int count) {
+            unsigned int taken = other._multiplicity(value, hash);
+            return count > taken ? count - taken : 0;
+        });
+        return result;
+    }
+
+    Set<T, H> symdiff(const Set<T, H>& other, const Executor& executor) const {
+        Set<T, H> parta = this->difference(other, executor);
+        Set<T, H> partb = other.difference(*this, executor);
+        return parta.union_(partb, executor);
+    }
 
-        for (const auto& value_a: *this)
-            for (const auto& value_b: other) {
-                Couple<T, T> couple(value_a, value_b);
-                result.add(couple);
+    Set<T, H> complement(const Set<T, H>& universal, const Executor& executor) const {
+        return universal.difference(*this, executor);
+    }
+
+    // Pairs of different elements are different, so they are appended with product of counts
+    Set<Couple<T, T>> product(const Set<T, H>& other, const Executor& executor) const {
+        SET_TIMER(product);
+        typedef Couple<T, T> Pair;
+        const unsigned int shards = executor.shards(this->distinct());
+        Vector<Vector<Pair>> pairs(shards, Vector<Pair>());
+        Vector<Vector<uint64_t>> hashes(shards, Vector<uint64_t>());
+
+        executor.run(this->distinct(), [&](unsigned int shard, size_t begin, size_t end) {
+            Hash<Pair> hasher;
+            pairs[shard].reserve((end - begin) * other.distinct());
+            hashes[shard].reserve((end - begin) * other.distinct());
+            for (size_t _ = begin; _ < end; _++)
+                for (const auto& value: other._elements) {
+                    const Pair& pair = pairs[shard].emplace(this->_elements[_], value);
+                    hashes[shard].append(hasher(pair));
+                }
+        });
+
+        Set<Pair> result(1, this->_unique);
+        result.reserve(this->distinct() * other.distinct());
+        size_t index = 0;
+        for (unsigned int shard = 0; shard < shards; shard++)
+            for (size_t _ = 0; _ < pairs[shard].count(); _++, index++) {
+                const unsigned int count = this->_count(index / other.distinct()) * other._count(index % other.distinct());
+                result._append(std::move(pairs[shard][_]), hashes[shard][_], count);
             }
 
         return result;
     }
 
     unsigned int multiplicity(const T& element) const {
-        unsigned int count = 0;
-        for (const auto& value: *this) {
-            if (element == value)
-                count++;
+        return this->_multiplicity(element, this->_hasher(element));
+    }
+
+    // Element with largest count, recomputed only after its count went down
+    Couple<T, unsigned int> mode() const {
+        if (this->_elements.empty())
+            throw std::out_of_range("Set is empty.");
+        if (this->_unique)
+            return Couple<T, unsigned int>(this->_elements[0], 1);
+
+        if (this->_stale) {
+            this->_mode = 0;
+            for (size_t _ = 1; _ < this->_elements.count(); _++)
+                if (this->_counts[_] > this->_counts[this->_mode])
+                    this->_mode = _;
+            this->_stale = false;
         }
-        return count;
+        return Couple<T, unsigned int>(this->_elements[this->_mode], this->_counts[this->_mode]);
     }
 
+    // Every different element with its count in insertion order
     Vector<Couple<T, unsigned int>> analysis() const {
-        // Find all significant elements
-        Set<T> unique(this->_size);
-        for (const auto element: *this)
-            unique.add((element));
-
-        // For all unique elements find multiplicity
         Vector<Couple<T, unsigned int>> result;
-        for (const auto element: unique)
-            result.append(Couple<T, unsigned int>(element, this->multiplicity(element)));
+        result.reserve(this->_elements.count());
+        for (size_t _ = 0; _ < this->_elements.count(); _++)
+            result.emplace(this->_elements[_], this->_count(_));
+
+        return result;
+    }
+
+};
+
+// Pairs of elements at same position of two sets, stops at shorter one
+template <typename T, typename H>
+class ZipView {
+private:
+    const Set<T, H>* _first;
+    const Set<T, H>* _second;
+
+public:
+    typedef Couple<const T&, const T&> Pair;
+
+    ZipView() = delete;
+    explicit ZipView(const Set<T, H>& first, const Set<T, H>& second):
+        _first(&first), _second(&second) {};
+
+    size_t count() const {
+        return std::min(this->_first->count(), this->_second->count());
+    }
+
+    Pair operator[](size_t index) const {
+        return Pair(this->_first->index(index), this->_second->index(index));
+    }
 
+    // Walks both sets with iterators, positional access would rescan counts of a multiset per pair
+    Set<Couple<T, T>> materialize() const {
+        Set<Couple<T, T>> result(1, !this->_first->multiple());
+        result.reserve(this->count());
+        for (auto iter = this->begin(); iter != this->end(); ++iter) {
+            const Pair pair = *iter;
+            result.add(Couple<T, T>(pair.first(), pair.second()));
+        }
         return result;
     }
 
+    // Steps both sets together and counts down pairs left, so shorter set ends range
+    class Iterator {
+    private:
+        typename Set<T, H>::Iterator _first;
+        typename Set<T, H>::Iterator _second;
+        size_t _left;
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(typename Set<T, H>::Iterator first, typename Set<T, H>::Iterator second, size_t left):
+            _first(first), _second(second), _left(left) {};
+        Pair operator*() const { return Pair(*this->_first, *this->_second); }
+        Iterator operator++() {
+            ++this->_first;
+            ++this->_second;
+            this->_left--;
+            return *this;
+        }
+        bool operator!=(const Iterator& iter) const {
+            return this->_left != iter._left;
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(this->_first->begin(), this->_second->begin(), this->count());
+    }
+    Iterator end() const {
+        return Iterator(this->_first->end(), this->_second->end(), 0);
+    }
+};
+
+// Cartesian product of two sets in row order, with O(1) count and membership
+template <typename T, typename H>
+class ProductView {
+private:
+    const Set<T, H>* _first;
+    const Set<T, H>* _second;
+
+public:
+    typedef Couple<const T&, const T&> Pair;
+
+    ProductView() = delete;
+    explicit ProductView(const Set<T, H>& first, const Set<T, H>& second):
+        _first(&first), _second(&second) {};
+
+    size_t count() const {
+        return this->_first->count() * this->_second->count();
+    }
+
+    Pair operator[](size_t index) const {
+        const size_t columns = this->_second->count();
+        return Pair(this->_first->index(index / columns), this->_second->index(index % columns));
+    }
+
+    bool in(const T& first, const T& second) const {
+        return this->_first->in(first) && this->_second->in(second);
+    }
+
+    Set<Couple<T, T>> materialize() const {
+        Set<Couple<T, T>> result(1, !this->_first->multiple());
+        result.reserve(this->count());
+        for (const auto& value_a: *this->_first)
+            for (const auto& value_b: *this->_second)
+                result.add(Couple<T, T>(value_a, value_b));
+        return result;
+    }
+
+    class Iterator {
+    private:
+        typedef typename Set<T, H>::Iterator Element;
+        Element _row;
+        Element _column;
+        Element _begin;
+        Element _end;
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(Element row, Element begin, Element end):
+            _row(row), _column(begin), _begin(begin), _end(end) {};
+        Pair operator*() const { return Pair(*this->_row, *this->_column); }
+        Iterator operator++() {
+            if (!(++this->_column != this->_end)) {
+                this->_column = this->_begin;
+                ++this->_row;
+            }
+            return *this;
+        }
+        bool operator!=(const Iterator& iter) const {
+            return this->_row != iter._row || this->_column != iter._column;
+        }
+    };
+
+    // Empty second set gives empty range by starting at last row
+    Iterator begin() const {
+        if (this->_second->count() == 0)
+            return this->end();
+        return Iterator(this->_first->begin(), this->_second->begin(), this->_second->end());
+    }
+    Iterator end() const {
+        return Iterator(this->_first->end(), this->_second->begin(), this->_second->end());
+    }
 };
 
 #endif //GRAYSET_SET_H
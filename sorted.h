@@ -0,0 +1,202 @@
+#ifndef GRAYSET_SORTED_H
+#define GRAYSET_SORTED_H
+
+#include "header.h"
+#include "vector.h"
+#include "set.h"
+
+#include <functional>
+
+// Sorted snapshot of a Set, set algebra runs as linear merges or galloping searches
+template <typename T, typename C = std::less<T>>
+class Sorted {
+private:
+    Vector<T> _elements;
+    C _compare;
+
+    // Ratio of operand sizes from which galloping beats a linear merge
+    static const size_t GALLOP_RATIO = 16;
+
+    // Empty result ordered by same comparator as its operands
+    explicit Sorted(const C& compare): _elements(), _compare(compare) {}
+
+    bool _less(const T& valuea, const T& valueb) const {
+        return this->_compare(valuea, valueb);
+    }
+
+    // First position not less than value, searched exponentially from start
+    size_t _gallop(const T& value, size_t start) const {
+        const size_t total = this->count();
+        if (start >= total || !this->_less(this->_elements[start], value))
+            return start;
+
+        size_t bound = 1;
+        while (start + bound < total && this->_less(this->_elements[start + bound], value))
+            bound <<= 1;
+
+        const T* data = this->_elements.data();
+        const T* position = std::lower_bound(
+                data + start + bound / 2 + 1, data + std::min(start + bound + 1, total), value,
+                [this](const T& valuea, const T& valueb) { return this->_less(valuea, valueb); });
+        return position - data;
+    }
+
+    // Every element of small is searched in large with a moving galloping window
+    static Sorted<T, C> _intersection_gallop(const Sorted<T, C>& small, const Sorted<T, C>& large, const C& compare) {
+        Sorted<T, C> result(compare);
+        size_t position = 0;
+        for (const auto& value: small) {
+            position = large._gallop(value, position);
+            if (position == large.count())
+                break;
+            if (!small._less(value, large._elements[position])) {
+                result._elements.append(value);
+                position++;
+            }
+        }
+        return result;
+    }
+
+    // Sort pointers so T only needs to be copy constructible
+    template <typename Container>
+    void _sort(const Container& elements) {
+        Vector<const T*> order;
+        order.reserve(elements.count());
+        for (const auto& value: elements)
+            order.append(&value);
+        std::sort(order.begin(), order.end(),
+                  [this](const T* valuea, const T* valueb) { return this->_less(*valuea, *valueb); });
+
+        this->_elements.reserve(order.count());
+        for (const auto value: order)
+            this->_elements.append(*value);
+    }
+
+public:
+    explicit Sorted(const Vector<T>& elements, const C& compare = C()): _compare(compare) {
+        this->_sort(elements);
+    }
+
+    template <typename H>
+    explicit Sorted(const Set<T, H>& set, const C& compare = C()): _compare(compare) {
+        this->_sort(set);
+    }
+
+    inline size_t count() const { return this->_elements.count(); }
+    bool multiple() const { return false; }
+
+    bool in(const T& value) const {
+        size_t position = this->_gallop(value, 0);
+        return position != this->count() && !this->_less(value, this->_elements[position]);
+    }
+
+    const T& index(size_t index) const { return this->_elements.get(index); }
+
+    const T* begin() const { return this->_elements.begin(); }
+    const T* end() const { return this->_elements.end(); }
+
+    // Back to hash based set keeping sorted order
+    template <typename H = Hash<T>>
+    Set<T, H> set() const {
+        return Set<T, H>::from_range(this->begin(), this->end(), true, Set<T, H>::SORTED);
+    }
+
+public:
+
+    // All arithmetic operations, cheaper strategy is picked from operand sizes
+    Sorted<T, C> intersection(const Sorted<T, C>& other) const {
+        if (this->count() * GALLOP_RATIO <= other.count())
+            return _intersection_gallop(*this, other, this->_compare);
+        if (other.count() * GALLOP_RATIO <= this->count())
+            return _intersection_gallop(other, *this, this->_compare);
+
+        Sorted<T, C> result(this->_compare);
+        size_t indexa = 0, indexb = 0;
+        while (indexa < this->count() && indexb < other.count()) {
+            const T& valuea = this->_elements[indexa];
+            const T& valueb = other._elements[indexb];
+            if (this->_less(valuea, valueb))
+                indexa++;
+            else if (this->_less(valueb, valuea))
+                indexb++;
+            else {
+                result._elements.append(valuea);
+                indexa++; indexb++;
+            }
+        }
+        return result;
+    }
+
+    Sorted<T, C> union_(const Sorted<T, C>& other) const {
+        Sorted<T, C> result(this->_compare);
+        result._elements.reserve(this->count() + other.count());
+        size_t indexa = 0, indexb = 0;
+        while (indexa < this->count() && indexb < other.count()) {
+            const T& valuea = this->_elements[indexa];
+            const T& valueb = other._elements[indexb];
+            if (this->_less(valuea, valueb)) {
+                result._elements.append(valuea);
+                indexa++;
+            } else if (this->_less(valueb, valuea)) {
+                result._elements.append(valueb);
+                indexb++;
+            } else {
+                result._elements.append(valuea);
+                indexa++; indexb++;
+            }
+        }
+        for (; indexa < this->count(); indexa++)
+            result._elements.append(this->_elements[indexa]);
+        for (; indexb < other.count(); indexb++)
+            result._elements.append(other._elements[indexb]);
+        return result;
+    }
+
+    Sorted<T, C> difference(const Sorted<T, C>& other) const {
+        Sorted<T, C> result(this->_compare);
+        const bool gallop = this->count() * GALLOP_RATIO <= other.count();
+        size_t position = 0;
+        for (const auto& value: this->_elements) {
+            if (gallop)
+                position = other._gallop(value, position);
+            else
+                while (position < other.count() && this->_less(other._elements[position], value))
+                    position++;
+
+            if (position == other.count() || this->_less(value, other._elements[position]))
+                result._elements.append(value);
+            else
+                position++;
+        }
+        return result;
+    }
+
+    Sorted<T, C> symdiff(const Sorted<T, C>& other) const {
+        Sorted<T, C> result(this->_compare);
+        size_t indexa = 0, indexb = 0;
+        while (indexa < this->count() && indexb < other.count()) {
+            const T& valuea = this->_elements[indexa];
+            const T& valueb = other._elements[indexb];
+            if (this->_less(valuea, valueb)) {
+                result._elements.append(valuea);
+                indexa++;
+            } else if (this->_less(valueb, valuea)) {
+                result._elements.append(valueb);
+                indexb++;
+            } else {
+                indexa++; indexb++;
+            }
+        }
+        for (; indexa < this->count(); indexa++)
+            result._elements.append(this->_elements[indexa]);
+        for (; indexb < other.count(); indexb++)
+            result._elements.append(other._elements[indexb]);
+        return result;
+    }
+
+    Sorted<T, C> complement(const Sorted<T, C>& universal) const {
+        return universal.difference(*this);
+    }
+};
+
+#endif //GRAYSET_SORTED_H
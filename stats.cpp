@@ -0,0 +1,34 @@
+#include "stats.h"
+
+#include <sstream>
+
+std::string SetStats::json() const {
+    std::ostringstream out;
+    out << "{\"count\": " << this->count
+        << ", \"distinct\": " << this->distinct
+        << ", \"slots\": " << this->slots
+        << ", \"load\": " << this->load
+        << ", \"max_load\": " << this->max_load
+        << ", \"longest_probe\": " << this->longest
+        << ", \"average_probe\": " << this->average
+        << ", \"displaced\": " << this->displaced
+        << ", \"collisions\": " << this->collisions
+        << ", \"element_bytes\": " << this->element_bytes
+        << ", \"overhead_bytes\": " << this->overhead_bytes
+        << ", \"probes\": [";
+    for (size_t _ = 0; _ < this->probes.count(); _++)
+        out << (_ == 0 ? "" : ", ") << this->probes[_];
+    out << "], \"counted\": " << (this->counted ? "true" : "false");
+
+    if (this->counted) {
+        out << ", \"resizes\": " << this->resizes << ", \"operations\": {";
+        for (size_t _ = 0; _ < this->operations.count(); _++) {
+            const Operation& operation = this->operations[_];
+            out << (_ == 0 ? "" : ", ") << '"' << operation.name << "\": {\"calls\": " << operation.calls
+                << ", \"nanoseconds\": " << operation.nanoseconds << '}';
+        }
+        out << '}';
+    }
+    out << '}';
+    return out.str();
+}
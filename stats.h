@@ -0,0 +1,99 @@
+#ifndef GRAYSET_STATS_H
+#define GRAYSET_STATS_H
+
+#include "header.h"
+#include "vector.h"
+
+#include <atomic>
+#include <chrono>
+
+// Calls and time spent in one kind of operation, relaxed atomics so const readers may share it
+struct Counter {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> nanoseconds;
+
+    Counter(): calls(0), nanoseconds(0) {}
+    Counter(const Counter& counter): calls(counter.calls.load()), nanoseconds(counter.nanoseconds.load()) {}
+
+    Counter& operator=(const Counter& counter) {
+        this->calls = counter.calls.load();
+        this->nanoseconds = counter.nanoseconds.load();
+        return *this;
+    }
+};
+
+// Adds one call and time from construction to destruction to counter
+class Timer {
+private:
+    Counter& _counter;
+    std::chrono::steady_clock::time_point _begin;
+
+public:
+    explicit Timer(Counter& counter): _counter(counter), _begin(std::chrono::steady_clock::now()) {}
+    Timer(const Timer& timer) = delete;
+
+    ~Timer() {
+        auto spent = std::chrono::steady_clock::now() - this->_begin;
+        this->_counter.calls.fetch_add(1, std::memory_order_relaxed);
+        this->_counter.nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count(), std::memory_order_relaxed);
+    }
+};
+
+// Operation counters of one set, only kept when SET_STATISTICS is defined
+struct SetCounters {
+    Counter add;
+    Counter in;
+    Counter remove;
+    Counter build;
+    Counter intersection;
+    Counter union_;
+    Counter difference;
+    Counter symdiff;
+    Counter complement;
+    Counter product;
+    Counter resize;
+};
+
+#ifdef SET_STATISTICS
+#define SET_TIMER(counter) Timer _timer(this->_counters.counter)
+#else
+#define SET_TIMER(counter)
+#endif
+
+// Snapshot of table shape and operation counters
+struct SetStats {
+    struct Operation {
+        const char* name;
+        uint64_t calls;
+        uint64_t nanoseconds;
+    };
+
+    size_t count = 0;
+    size_t distinct = 0;
+    size_t slots = 0;
+    double load = 0;
+    double max_load = 0;
+
+    // Element count per probe length, index zero is an element in its home slot
+    Vector<size_t> probes;
+    size_t longest = 0;
+    double average = 0;
+    size_t displaced = 0;
+
+    // Different elements with equal full hash
+    size_t collisions = 0;
+
+    // Storage of element objects and of index, hashes and counts around them
+    size_t element_bytes = 0;
+    size_t overhead_bytes = 0;
+
+    // Filled only when counters are compiled in
+    bool counted = false;
+    uint64_t resizes = 0;
+    Vector<Operation> operations;
+
+    std::string json() const;
+};
+
+#endif //GRAYSET_STATS_H
@@ -0,0 +1,269 @@
+#include "storage.h"
+#include "format.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char MAGIC[4] = {'G', 'S', 'E', 'T'};
+
+// Payload words needed by representation, bitmap covers whole universe
+static uint64_t words_of(uint16_t representation, uint32_t width, uint64_t count) {
+    switch (representation) {
+        case MappedSet::PACKED:
+            return count * width / 64 + (count * width % 64 != 0);
+        case MappedSet::SORTED:
+            return count;
+        default:
+            return ((1ull << width) + 63) / 64;
+    }
+}
+
+// Width shared by all codes, empty set has width zero
+static uint32_t width_of(const Set<Gray>& set) {
+    if (set.count() == 0)
+        return 0;
+    const size_t width = (*set.begin()).size();
+    if (width > 64)
+        throw std::invalid_argument("Codes wider than 64 bits can not be saved.");
+    for (const auto& value: set)
+        if (value.size() != width)
+            throw std::invalid_argument("Gray sizes are not equal.");
+    return static_cast<uint32_t>(width);
+}
+
+static void write_header(Writer& out, uint16_t representation, uint32_t width, uint32_t flags, uint64_t count) {
+    StorageHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MappedSet::VERSION;
+    header.representation = representation;
+    header.width = width;
+    header.flags = flags;
+    header.count = count;
+    header.words = words_of(representation, width, count);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+static void write_words(Writer& out, const uint64_t* words, size_t count) {
+    out.write(reinterpret_cast<const char*>(words), count * sizeof(uint64_t));
+}
+
+void save(const Set<Gray>& set, const char* path, MappedSet::Representation representation) {
+    const uint32_t width = width_of(set);
+    const uint32_t flags = set.multiple() ? MappedSet::COUNTED : 0;
+    if (representation == MappedSet::BITMAP) {
+        if (set.multiple())
+            throw std::invalid_argument("Bitmap can not keep counts of multiset.");
+        save(BitSet(width, set), path);
+        return;
+    }
+
+    Writer out(path);
+    write_header(out, representation, width, flags, set.count());
+
+    // Sorted file keeps every copy of multiset element next to each other
+    if (representation == MappedSet::SORTED) {
+        Vector<uint64_t> codes;
+        codes.reserve(set.count());
+        for (const auto& value: set)
+            codes.append(value.decimal());
+        std::sort(codes.begin(), codes.end());
+        write_words(out, codes.data(), codes.count());
+        out.flush();
+        return;
+    }
+
+    // Codes are streamed into words, a code may continue in next word
+    uint64_t word = 0;
+    unsigned int used = 0;
+    for (const auto& value: set) {
+        const uint64_t code = value.decimal();
+        word |= code << used;
+        used += width;
+        if (used >= 64) {
+            write_words(out, &word, 1);
+            used -= 64;
+            word = used == 0 ? 0 : code >> (width - used);
+        }
+    }
+    if (used != 0)
+        write_words(out, &word, 1);
+    out.flush();
+}
+
+void save(const BitSet& set, const char* path) {
+    Writer out(path);
+    write_header(out, MappedSet::BITMAP, set.power(), 0, set.count());
+    write_words(out, set.data(), set.words());
+    out.flush();
+}
+
+Set<Gray> load(const char* path) {
+    return MappedSet(path).set();
+}
+
+MappedSet::MappedSet(const char* path): _map(nullptr), _length(0), _header(nullptr), _words(nullptr) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Can not open file ") + path);
+
+    struct stat status = {};
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(StorageHeader)) {
+        close(fd);
+        throw std::runtime_error("Set file is too short.");
+    }
+    this->_length = status.st_size;
+    void* map = mmap(nullptr, this->_length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw std::runtime_error("Can not map set file.");
+    this->_map = static_cast<const char*>(map);
+    this->_header = reinterpret_cast<const StorageHeader*>(this->_map);
+    this->_words = reinterpret_cast<const uint64_t*>(this->_map + sizeof(StorageHeader));
+
+    // Header has to describe exactly what follows it
+    const StorageHeader& header = *this->_header;
+    const char* error = nullptr;
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        error = "Not a set file.";
+    else if (header.version != VERSION)
+        error = "Unsupported set file version.";
+    else if (header.representation > BITMAP || header.width > 64 ||
+             (header.representation == BITMAP && header.width > BitSet::MAX_POWER))
+        error = "Unsupported set representation.";
+    // Packed bit length must not wrap around, or a tiny word count would pass the size check
+    else if (header.representation == PACKED && header.width != 0 && header.count > ~0ull / header.width)
+        error = "Set file count is out of range.";
+    else if (header.words != words_of(header.representation, header.width, header.count) ||
+             header.words > (this->_length - sizeof(StorageHeader)) / sizeof(uint64_t))
+        error = "Set file is truncated.";
+    // Distinct codes can not outnumber universe, width zero holds only the empty code
+    else if (!(header.flags & COUNTED) && header.width < 64 && header.count > (1ull << header.width))
+        error = "Set file count is out of range.";
+    // Copies of the single empty code must fit one element count
+    else if (header.representation == PACKED && header.width == 0 &&
+             header.count > std::numeric_limits<unsigned int>::max())
+        error = "Set file count is out of range.";
+    // Bitmap of a universe below one word must leave bits past its end clear
+    else if (header.representation == BITMAP && header.width < 6 && this->_words[0] >> (1u << header.width))
+        error = "Set file bitmap does not match its count.";
+    else if (header.representation == BITMAP &&
+             ((header.flags & COUNTED) || header.count != this->_population()))
+        error = "Set file bitmap does not match its count.";
+    if (error != nullptr) {
+        this->_release();
+        throw std::runtime_error(error);
+    }
+}
+
+MappedSet::MappedSet(MappedSet&& set) noexcept:
+_map(set._map), _length(set._length), _header(set._header), _words(set._words) {
+    set._map = nullptr;
+    set._length = 0;
+    set._header = nullptr;
+    set._words = nullptr;
+}
+
+size_t MappedSet::_population() const {
+    size_t count = 0;
+    for (uint64_t _ = 0; _ < this->_header->words; _++)
+        count += popcount(this->_words[_]);
+    return count;
+}
+
+void MappedSet::_release() {
+    if (this->_map != nullptr)
+        munmap(const_cast<char*>(this->_map), this->_length);
+    this->_map = nullptr;
+}
+
+uint64_t MappedSet::code(size_t index) const {
+    if (this->representation() == BITMAP || index >= this->count())
+        throw std::out_of_range("Invalid index value.");
+    if (this->representation() == SORTED)
+        return this->_words[index];
+
+    const unsigned int width = this->width();
+    if (width == 0)
+        return 0;
+    const uint64_t offset = static_cast<uint64_t>(index) * width;
+    const size_t word = offset / 64;
+    const unsigned int shift = offset % 64;
+    uint64_t value = this->_words[word] >> shift;
+    if (shift + width > 64)
+        value |= this->_words[word + 1] << (64 - shift);
+    return width == 64 ? value : value & ((1ull << width) - 1);
+}
+
+bool MappedSet::in(uint64_t code) const {
+    if (this->width() < 64 && code >> this->width())
+        return false;
+    switch (this->representation()) {
+        case BITMAP:
+            return (this->_words[code / 64] >> (code % 64)) & 1u;
+        case SORTED:
+            return std::binary_search(this->_words, this->_words + this->count(), code);
+        default:
+            for (size_t _ = 0; _ < this->count(); _++)
+                if (this->code(_) == code)
+                    return true;
+            return false;
+    }
+}
+
+MappedSet::Iterator MappedSet::end() const {
+    if (this->representation() == BITMAP)
+        return Iterator(this, this->_header->words);
+    return Iterator(this, this->count());
+}
+
+Set<Gray> MappedSet::set() const {
+    Set<Gray> result(1, !this->multiple());
+    // Payload bounds the reservation, count alone may claim many empty codes
+    Vector<Gray> codes;
+    codes.reserve(std::min<uint64_t>(this->count(), this->_header == nullptr ? 0 : this->_header->words * 64));
+    for (auto iter = this->begin(); iter != this->end(); ++iter)
+        codes.append(*iter);
+
+    // Only packed file can hold repeated codes apart from each other
+    switch (this->representation()) {
+        case PACKED:
+            result.add_range(std::move(codes));
+            break;
+        case SORTED:
+            result.add_range(std::move(codes), Set<Gray>::SORTED);
+            break;
+        default:
+            result.add_range(std::move(codes), Set<Gray>::DISTINCT);
+    }
+    return result;
+}
+
+MappedSet::Iterator::Iterator(const MappedSet* set, size_t index): _set(set), _index(index), _rest(0) {
+    if (set->representation() == BITMAP && index < set->_header->words) {
+        this->_rest = set->_words[index];
+        this->_skip();
+    }
+}
+
+void MappedSet::Iterator::_skip() {
+    while (this->_rest == 0 && ++this->_index < this->_set->_header->words)
+        this->_rest = this->_set->_words[this->_index];
+}
+
+uint64_t MappedSet::Iterator::code() const {
+    if (this->_set->representation() == BITMAP)
+        return this->_index * 64 + ctz(this->_rest);
+    return this->_set->code(this->_index);
+}
+
+MappedSet::Iterator MappedSet::Iterator::operator++() {
+    if (this->_set->representation() == BITMAP) {
+        this->_rest &= this->_rest - 1;
+        this->_skip();
+    } else {
+        this->_index++;
+    }
+    return *this;
+}
@@ -0,0 +1,111 @@
+#ifndef GRAYSET_STORAGE_H
+#define GRAYSET_STORAGE_H
+
+#include "header.h"
+#include "gray.h"
+#include "set.h"
+#include "bitset.h"
+
+// File layout: header followed by payload words, native byte order, payload is 8 byte aligned
+struct StorageHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t representation;
+    uint32_t width;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t words;
+};
+
+// Read only view of a set file mapped into memory, nothing is copied or hashed on open
+// Header is checked against payload, bitmap words are counted once to confirm its count
+class MappedSet {
+public:
+    enum Representation {
+        PACKED,     // Codes in iteration order, width bits each without padding
+        SORTED,     // One word per code in ascending order, lookups by binary search
+        BITMAP      // One bit per code of whole 2^width universe
+    };
+
+    static const uint16_t VERSION = 1;
+    static const uint32_t COUNTED = 1;
+
+private:
+    const char* _map;
+    size_t _length;
+    const StorageHeader* _header;
+    const uint64_t* _words;
+
+    void _release();
+
+    // Set bits of bitmap payload
+    size_t _population() const;
+
+public:
+    MappedSet() = delete;
+    MappedSet(const MappedSet& set) = delete;
+    MappedSet& operator=(const MappedSet& set) = delete;
+
+    // Throws runtime_error when file can not be mapped or its header does not fit its size
+    explicit MappedSet(const char* path);
+    MappedSet(MappedSet&& set) noexcept;
+
+    // Moved from view has no header and reads as an empty packed set
+    size_t count() const { return this->_header == nullptr ? 0 : this->_header->count; }
+    unsigned int width() const { return this->_header == nullptr ? 0 : this->_header->width; }
+    Representation representation() const {
+        return this->_header == nullptr ? PACKED : static_cast<Representation>(this->_header->representation);
+    }
+    bool multiple() const { return this->_header != nullptr && (this->_header->flags & COUNTED); }
+
+    // Code at position of packed or sorted file
+    uint64_t code(size_t index) const;
+
+    // Packed file is scanned, sorted file is searched and bitmap is tested directly
+    bool in(uint64_t code) const;
+    bool in(const Gray& value) const {
+        return value.size() == this->width() && this->in(value.decimal());
+    }
+
+    class Iterator {
+    private:
+        const MappedSet* _set;
+        size_t _index;
+        uint64_t _rest;
+
+        // Move to next bitmap word that still has bits
+        void _skip();
+
+    public:
+        Iterator() = delete;
+        explicit Iterator(const MappedSet* set, size_t index);
+
+        uint64_t code() const;
+        Gray operator*() const {
+            Gray gray(this->_set->width());
+            gray.decimal(this->code());
+            return gray;
+        }
+        Iterator operator++();
+        bool operator!=(const Iterator& iter) const {
+            return this->_index != iter._index || this->_rest != iter._rest;
+        }
+    };
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const;
+
+    // Copy into hash based set
+    Set<Gray> set() const;
+
+    ~MappedSet() { this->_release(); }
+};
+
+// Write set to file, codes must share one width of at most 64 bits
+void save(const Set<Gray>& set, const char* path, MappedSet::Representation representation = MappedSet::SORTED);
+void save(const BitSet& set, const char* path);
+
+// Read whole file into hash based set
+Set<Gray> load(const char* path);
+
+#endif //GRAYSET_STORAGE_H
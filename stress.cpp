@@ -0,0 +1,106 @@
+#include "functions.h"
+#include "concurrent.h"
+#include "executor.h"
+
+#include <chrono>
+#include <atomic>
+
+// Stress and throughput check of concurrent set over all codes of a power
+typedef std::chrono::steady_clock Clock;
+
+static double elapsed(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static double rate(size_t operations, double seconds) {
+    return seconds > 0 ? operations / seconds / 1e6 : 0;
+}
+
+int main(int argc, const char* argv[]) {
+    unsigned int power = argc > 1 ? strtoul(argv[1], nullptr, 10) : 18;
+    unsigned int most = argc > 2 ? strtoul(argv[2], nullptr, 10) : 0;
+
+    // All codes are kept in memory, so power is limited well below sequence maximum
+    if (power == 0 || power > 28) {
+        std::cout << "Invalid power range." << std::endl;
+        return 2;
+    }
+    if (most == 0)
+        most = std::max(4u, std::thread::hardware_concurrency());
+
+    GraySequence sequence(power);
+    Vector<Gray> codes;
+    codes.reserve(sequence.count());
+    for (auto iter = sequence.begin(); iter != sequence.end(); ++iter)
+        codes.append(iter.gray());
+    const size_t total = codes.count();
+
+    // Codes every writer adds as well, so some stripes see contended duplicates
+    const size_t shared = std::min<size_t>(total, 1024);
+
+    std::cout << "Power " << power << ", " << total << " codes" << std::endl;
+    std::cout << "Threads\tInsert\tLookup\tMixed\t(Mops/s)\tCheck" << std::endl;
+
+    bool failed = false;
+    for (unsigned int threads = 1; threads <= most; threads *= 2) {
+        Executor executor(threads, 1);
+        ConcurrentSet<Gray> set(1024);
+        bool valid = true;
+
+        // Writers add own chunk and the shared prefix
+        auto begin = Clock::now();
+        executor.run(total, [&](unsigned int, size_t first, size_t last) {
+            for (size_t _ = 0; _ < shared; _++)
+                set.add(codes[_]);
+            for (size_t _ = first; _ < last; _++)
+                set.add(codes[_]);
+        });
+        double insert = elapsed(begin);
+        size_t inserted = total + shared * executor.shards(total);
+        valid = valid && set.count() == total;
+
+        // Readers look up every code, misses are counted
+        std::atomic<size_t> missing(0);
+        begin = Clock::now();
+        executor.run(total, [&](unsigned int, size_t first, size_t last) {
+            size_t miss = 0;
+            for (size_t _ = first; _ < last; _++)
+                miss += !set.in(codes[_]);
+            missing += miss;
+        });
+        double lookup = elapsed(begin);
+        valid = valid && missing == 0;
+
+        // Even shards remove even codes of their chunk, odd shards read the same time
+        begin = Clock::now();
+        executor.run(total, [&](unsigned int shard, size_t first, size_t last) {
+            if (shard % 2 == 0) {
+                for (size_t _ = first; _ < last; _ += 2)
+                    set.remove(codes[_]);
+                return;
+            }
+            size_t miss = 0;
+            for (size_t _ = first; _ < last; _++)
+                miss += !set.in(codes[_]);
+            missing += miss;
+        });
+        double mixed = elapsed(begin);
+
+        // Only removed codes may be absent
+        const unsigned int shards = executor.shards(total);
+        const size_t chunk = (total + shards - 1) / shards;
+        for (size_t _ = 0; _ < total && valid; _++) {
+            bool removed = (_ / chunk) % 2 == 0 && (_ % chunk) % 2 == 0;
+            valid = set.in(codes[_]) != removed;
+        }
+        failed = failed || !valid;
+
+        std::cout << threads << '\t'
+                  << rate(inserted, insert) << '\t'
+                  << rate(total, lookup) << '\t'
+                  << rate(total, mixed) << "\t\t"
+                  << (valid ? "OK" : "FAILED") << std::endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+#include "functions.h"
+#include "executor.h"
+#include "sorted.h"
+
+// Checks of set operations on edge cases, exit status is nonzero when any check fails
+static bool failed = false;
+
+static void check(bool truth, const char* what) {
+    if (!truth) {
+        std::cout << "Failed: " << what << std::endl;
+        failed = true;
+    }
+}
+
+static Set<int> filled(bool unique) {
+    Set<int> set(16, unique);
+    for (int _ = 0; _ < 100; _++)
+        set.add(_ % 60);
+    return set;
+}
+
+// Moved from set has no index, every operation must still treat it as empty
+static void moved(bool unique) {
+    const Executor executor(2, 1);
+    Set<int> constructed = filled(unique), assigned = filled(unique);
+    const Set<int> full(std::move(constructed));
+    Set<int> target(1, unique);
+    target = std::move(assigned);
+    const size_t count = full.count();
+
+    for (Set<int>* set: {&constructed, &assigned}) {
+        Set<int>& empty = *set;
+        check(empty.count() == 0 && !empty.in(3), "moved from set is empty");
+
+        check(empty.intersection(empty).count() == 0, "intersection of moved from sets");
+        check(empty.union_(empty).count() == 0, "union of moved from sets");
+        check(empty.difference(empty).count() == 0, "difference of moved from sets");
+        check(empty.symdiff(empty).count() == 0, "symdiff of moved from sets");
+        check(empty.complement(empty).count() == 0, "complement of moved from sets");
+
+        check(empty.intersection(full).count() == 0, "intersection with moved from set");
+        check(empty.union_(full).count() == count, "union with moved from set");
+        check(full.union_(empty).count() == count, "union into moved from set");
+        check(empty.difference(full).count() == 0, "difference of moved from set");
+        check(full.difference(empty).count() == count, "difference by moved from set");
+        check(empty.symdiff(full).count() == count, "symdiff with moved from set");
+        check(empty.complement(full).count() == count, "complement of moved from set");
+        check(full.complement(empty).count() == 0, "complement in moved from universe");
+        check(empty.merge(full).count() == count, "merge with moved from set");
+        check(empty.product(full).count() == 0, "product with moved from set");
+        check(empty.sum(full).count() == 0, "sum with moved from set");
+
+        check(empty.intersection(full, executor).count() == 0, "parallel intersection with moved from set");
+        check(empty.union_(full, executor).count() == count, "parallel union with moved from set");
+        check(empty.difference(full, executor).count() == 0, "parallel difference of moved from set");
+        check(empty.symdiff(full, executor).count() == count, "parallel symdiff with moved from set");
+        check(empty.complement(full, executor).count() == count, "parallel complement of moved from set");
+
+        Set<int> copy(empty);
+        copy |= full;
+        check(copy.count() == count, "copy of moved from set");
+
+        empty &= full;
+        empty -= full;
+        empty ^= empty;
+        check(empty.count() == 0, "in place operations on moved from set");
+
+        empty.add(5);
+        empty.add(5);
+        check(empty.in(5) && empty.count() == (unique ? 1u : 2u), "add to moved from set");
+        empty.remove(5);
+        check(empty.count() == (unique ? 0u : 1u), "remove from moved from set");
+    }
+}
+
+// Comparator with state and no default constructor, results must keep it
+struct Descending {
+    bool reverse;
+    explicit Descending(bool reverse): reverse(reverse) {}
+    bool operator()(int valuea, int valueb) const { return this->reverse ? valuea > valueb : valuea < valueb; }
+};
+
+static void sorted() {
+    Vector<int> valuesa, valuesb, few;
+    for (int _ = 0; _ < 100; _++) {
+        valuesa.append(_);
+        valuesb.append(_ + 50);
+    }
+    few.append(60);
+    few.append(10);
+    const Descending compare(true);
+    const Sorted<int, Descending> sorteda(valuesa, compare), sortedb(valuesb, compare), sortedc(few, compare);
+
+    const auto both = sorteda.intersection(sortedb);
+    check(both.count() == 50 && *both.begin() == 99 && both.in(70), "sorted intersection keeps comparator");
+    const auto gallop = sortedc.intersection(sorteda);
+    check(gallop.count() == 2 && *gallop.begin() == 60 && gallop.in(10), "galloping intersection keeps comparator");
+    const auto all = sorteda.union_(sortedb);
+    check(all.count() == 150 && *all.begin() == 149 && all.in(0), "sorted union keeps comparator");
+    const auto rest = sorteda.difference(sortedb);
+    check(rest.count() == 50 && *rest.begin() == 49 && rest.in(0), "sorted difference keeps comparator");
+    const auto either = sorteda.symdiff(sortedb);
+    check(either.count() == 100 && *either.begin() == 149 && either.in(0) && !either.in(70),
+          "sorted symdiff keeps comparator");
+    check(sortedb.complement(all).count() == 50, "sorted complement keeps comparator");
+}
+
+int main() {
+    moved(true);
+    moved(false);
+    sorted();
+    if (failed)
+        return 1;
+    std::cout << "All checks passed." << std::endl;
+    return 0;
+}
@@ -2,60 +2,155 @@
 #define GRAYSET_VECTOR_H
 
 #include "header.h"
+#include "arena.h"
 
-template <typename T>
-class Node {
-public:
-    T* _data;
-    Node* _next;
-
-public:
-    Node() = delete;
-    explicit Node(const T& value) {
-        this->_data = new T(value);
-        this->_next = nullptr;
-    }
-    bool isend() const { return (this->_next == nullptr); }
-    const T& value() { return *this->_data; }
-    ~Node() { free(this->_data); }
-};
+#include <utility>
 
 template <typename T>
 class Vector {
 private:
     size_t _size;
-    Node<T>* _header;
+    size_t _capacity;
+    T* _data;
+    Arena* _arena;
+
+    T* _allocate(size_t capacity) const {
+        if (capacity == 0)
+            return nullptr;
+        if (capacity > SIZE_MAX / sizeof(T))
+            throw std::bad_alloc();
+        if (this->_arena != nullptr)
+            return static_cast<T*>(this->_arena->allocate(sizeof(T) * capacity, alignof(T)));
+        return static_cast<T*>(::operator new(sizeof(T) * capacity));
+    }
+
+    // Arena memory is only given back when arena is released
+    void _deallocate(T* data) const {
+        if (this->_arena == nullptr)
+            ::operator delete(data);
+    }
+
+    // Move elements into a bigger block, copy when moving may throw
+    void _relocate(T* data) {
+        for (size_t _ = 0; _ < this->_size; _++) {
+            new (data + _) T(std::move_if_noexcept(this->_data[_]));
+            this->_data[_].~T();
+        }
+        this->_deallocate(this->_data);
+        this->_data = data;
+    }
+
+    // Copy of element, types that can live in arena get their storage from it too
+    void _copy(T* place, const T& value) {
+        if constexpr (ArenaCopy<T>::value) {
+            if (this->_arena != nullptr) {
+                new (place) T(value, this->_arena);
+                return;
+            }
+        }
+        new (place) T(value);
+    }
+
+    size_t _next() const {
+        return this->_capacity == 0 ? 4 : this->_capacity * 2;
+    }
 
 public:
-    Vector(): _size(0), _header(nullptr) {}
+    Vector(): _size(0), _capacity(0), _data(nullptr), _arena(nullptr) {}
+
+    explicit Vector(Arena* arena): _size(0), _capacity(0), _data(nullptr), _arena(arena) {}
+
+    explicit Vector(size_t count, const T& value, Arena* arena = nullptr): Vector(arena) {
+        this->resize(count, value);
+    }
+
+    // Copy never shares arena of source, it may outlive that arena
+    Vector(const Vector<T>& vector): Vector() {
+        this->reserve(vector._size);
+        for (size_t _ = 0; _ < vector._size; _++)
+            new (this->_data + _) T(vector._data[_]);
+        this->_size = vector._size;
+    }
+
+    Vector(Vector<T>&& vector) noexcept:
+    _size(vector._size), _capacity(vector._capacity), _data(vector._data), _arena(vector._arena) {
+        vector._size = 0;
+        vector._capacity = 0;
+        vector._data = nullptr;
+    }
+
+    Vector<T>& operator=(Vector<T> vector) {
+        std::swap(this->_size, vector._size);
+        std::swap(this->_capacity, vector._capacity);
+        std::swap(this->_data, vector._data);
+        std::swap(this->_arena, vector._arena);
+        return *this;
+    }
+
     size_t count() const { return this->_size; }
+    size_t capacity() const { return this->_capacity; }
+    Arena* arena() const { return this->_arena; }
 
-    void append(const T& value) {
-        Node<T>* current = this->_header;
-        auto next = new Node<T>(value);
+    void reserve(size_t capacity) {
+        if (capacity <= this->_capacity)
+            return;
 
-        // For insertion as first element
-        if (current == nullptr) {
-            this->_header = next;
-            this->_size += 1;
+        // Top allocation of an arena can grow without moving elements
+        if (this->_arena != nullptr && this->_data != nullptr &&
+            this->_arena->extend(this->_data, sizeof(T) * this->_capacity, sizeof(T) * capacity)) {
+            this->_capacity = capacity;
             return;
         }
+        this->_relocate(this->_allocate(capacity));
+        this->_capacity = capacity;
+    }
 
-        while (!current->isend())
-            current = current->_next;
-        current->_next = next;
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        if (this->_size < this->_capacity)
+            return *new (this->_data + this->_size++) T(std::forward<Args>(args)...);
+
+        // Construct before relocating, arguments may refer to current elements
+        size_t capacity = this->_next();
+        if (this->_arena != nullptr && this->_data != nullptr &&
+            this->_arena->extend(this->_data, sizeof(T) * this->_capacity, sizeof(T) * capacity)) {
+            this->_capacity = capacity;
+            return *new (this->_data + this->_size++) T(std::forward<Args>(args)...);
+        }
+        T* data = this->_allocate(capacity);
+        T* element = new (data + this->_size) T(std::forward<Args>(args)...);
+        this->_relocate(data);
+        this->_capacity = capacity;
+        this->_size++;
+        return *element;
+    }
 
-        this->_size += 1;
+    void append(const T& value) {
+        if constexpr (ArenaCopy<T>::value) {
+            if (this->_arena != nullptr) {
+                this->emplace(value, this->_arena);
+                return;
+            }
+        }
+        this->emplace(value);
     };
 
-    const T& get(size_t index) {
-        if (index >= this->_size || index < 0 || this->_header == nullptr)
-            throw std::out_of_range("Invalid index value.");
+    void append(T&& value) {
+        this->emplace(std::move(value));
+    }
+
+    // Grow or shrink to given count, new elements are copies of value
+    void resize(size_t count, const T& value) {
+        this->truncate(count);
+        this->reserve(count);
+        while (this->_size < count)
+            this->_copy(this->_data + this->_size++, value);
+    }
 
-        Node<T>* current = this->_header;
-        for (size_t _ = 0; _ < index; _++)
-            current = current->_next;
-        return *current->_data;
+    const T& get(size_t index) const {
+        if (index >= this->_size)
+            throw std::out_of_range("Invalid index value.");
+        return this->_data[index];
     }
 
     bool empty() const {
@@ -63,99 +158,87 @@ public:
     }
 
     bool exist(const T& value) const {
-        Node<T>* current = this->_header;
-        if (this->_header == nullptr)
-            return false;
-
-        while (!current->isend()) {
-            if (current->value() == value)
+        for (size_t _ = 0; _ < this->_size; _++)
+            if (this->_data[_] == value)
                 return true;
-            current = current->_next;
-        }
-
-        // Check for last item
-        if (current->value() == value)
-            return true;
-
         return false;
     };
 
     // Remove one element
     void remove(const T& value) {
-        Node<T>* current = this->_header;
-        if (this->_header == nullptr)
-            return;
-
-        size_t index = 0;
-        while (!current->isend()) {
-            if (current->value() == value) {
+        for (size_t index = 0; index < this->_size; index++) {
+            if (this->_data[index] == value) {
                 this->pop(index);
                 return;
             }
-            current = current->_next;
-            index++;
         }
     }
 
     T& index(size_t index) {
-        if (index >= this->_size || index < 0 || this->_header == nullptr)
+        if (index >= this->_size)
             throw std::out_of_range("Invalid index value.");
+        return this->_data[index];
+    }
 
-        Node<T>* current = this->_header;
-        for (size_t _ = 0; _ < index; _++) {
-            current = current -> _next;
-        }
-        return *current->_data;
+    const T& index(size_t index) const {
+        return this->get(index);
     }
 
+    // Unchecked access for hot paths
+    T& operator[](size_t index) { return this->_data[index]; }
+    const T& operator[](size_t index) const { return this->_data[index]; }
+
     T pop(size_t index) {
-        if (index >= this->_size || index < 0 || this->_header == nullptr)
+        if (index >= this->_size)
             throw std::out_of_range("Invalid index value.");
 
-        Node<T>* next = nullptr;
-        Node<T>* previous = this->_header;
-        Node<T>* current = this->_header;
-
-        for (size_t _ = 0; _ < index; _++) {
-            previous = current;
-            current = current -> _next;
-        }
-        T value = *current->_data;
-        this->_size -= 1;
-
-        // For removing of first element
-        if (current == this->_header){
-            this->_header = current->_next;
-            delete current;
-            return value;
+        // Shift following elements down to keep order
+        T value(std::move(this->_data[index]));
+        for (size_t _ = index; _ + 1 < this->_size; _++) {
+            this->_data[_].~T();
+            new (this->_data + _) T(std::move(this->_data[_ + 1]));
         }
+        this->_data[--this->_size].~T();
+        return value;
+    };
 
-        // For removing of last element
-        if (current->isend()) {
-            delete current;
-            previous->_next = nullptr;
-            return value;
+    // Remove element in O(1) by moving last element into its place, order not kept
+    T swap_pop(size_t index) {
+        if (index >= this->_size)
+            throw std::out_of_range("Invalid index value.");
+
+        T value(std::move(this->_data[index]));
+        size_t last = this->_size - 1;
+        if (index != last) {
+            this->_data[index].~T();
+            new (this->_data + index) T(std::move(this->_data[last]));
         }
+        this->_data[last].~T();
+        this->_size--;
+        return value;
+    }
 
-        next = current->_next;
-        delete current;
-        previous->_next = next;
+    // Drop elements from given count onwards, capacity is kept
+    void truncate(size_t count) {
+        while (this->_size > count)
+            this->_data[--this->_size].~T();
+    }
 
-        return value;
-    };
+    void clear() {
+        this->truncate(0);
+    }
 
-    ~Vector() {
-        Node<T>* next;
-        Node<T>* current = this->_header;
-        if (current == nullptr)
-            return;
+    T* data() { return this->_data; }
+    const T* data() const { return this->_data; }
 
-        while (!current->isend()) {
-            next = current->_next;
-            delete current;
-            current = next;
-        }
-        delete current;
+    T* begin() { return this->_data; }
+    T* end() { return this->_data + this->_size; }
+    const T* begin() const { return this->_data; }
+    const T* end() const { return this->_data + this->_size; }
+
+    ~Vector() {
+        this->clear();
+        this->_deallocate(this->_data);
     };
 };
 